@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include <string.h>
 #include <glib-object.h>
 #include <glib/gprintf.h>
 #include <json-glib/json-glib.h>
@@ -115,3 +116,98 @@ gdouble json_node_really_get_double(JsonNode * node)
         return 0.0;
     }
 }
+
+/* 64 bit FNV-1a, for noticing when a node's value has changed without
+ * having to keep the old node around. The members of an object are
+ * combined in a way that doesn't depend on their order.
+ */
+
+#define DIGEST_OFFSET G_GUINT64_CONSTANT(14695981039346656037)
+#define DIGEST_PRIME G_GUINT64_CONSTANT(1099511628211)
+
+static guint64 digest_bytes(guint64 h, gconstpointer data, gsize len)
+{
+    const guchar *p = (const guchar *) data;
+    gsize i;
+
+    for (i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= DIGEST_PRIME;
+    }
+
+    return h;
+}
+
+static guint64 json_node_digest_from(JsonNode * node, guint64 h)
+{
+    guchar type = (guchar) JSON_NODE_TYPE(node);
+
+    h = digest_bytes(h, &type, sizeof(type));
+
+    switch (JSON_NODE_TYPE(node)) {
+    case JSON_NODE_OBJECT:{
+            JsonObject *obj = json_node_get_object(node);
+            GList *members = json_object_get_members(obj);
+            GList *li;
+            guint64 sum = 0;
+
+            for (li = members; li; li = g_list_next(li)) {
+                const gchar *name = (const gchar *) li->data;
+                guint64 m = digest_bytes(DIGEST_OFFSET, name,
+                                         strlen(name) + 1);
+                sum += json_node_digest_from(json_object_get_member
+                                             (obj, name), m);
+            }
+
+            g_list_free(members);
+            h = digest_bytes(h, &sum, sizeof(sum));
+            break;
+        }
+    case JSON_NODE_ARRAY:{
+            JsonArray *array = json_node_get_array(node);
+            guint i, n = json_array_get_length(array);
+
+            for (i = 0; i < n; i++)
+                h = json_node_digest_from(json_array_get_element(array, i),
+                                          h);
+
+            h = digest_bytes(h, &n, sizeof(n));
+            break;
+        }
+    case JSON_NODE_VALUE:
+        switch (json_node_get_value_type(node)) {
+        case G_TYPE_INT64:{
+                gint64 v = json_node_get_int(node);
+                h = digest_bytes(h, &v, sizeof(v));
+                break;
+            }
+        case G_TYPE_DOUBLE:{
+                gdouble v = json_node_get_double(node);
+                h = digest_bytes(h, &v, sizeof(v));
+                break;
+            }
+        case G_TYPE_BOOLEAN:{
+                guchar v = json_node_get_boolean(node) ? 1 : 0;
+                h = digest_bytes(h, &v, sizeof(v));
+                break;
+            }
+        case G_TYPE_STRING:{
+                const gchar *v = json_node_get_string(node);
+                h = digest_bytes(h, v, strlen(v) + 1);
+                break;
+            }
+        default:
+            break;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return h;
+}
+
+guint64 json_node_digest(JsonNode * node)
+{
+    return node ? json_node_digest_from(node, DIGEST_OFFSET) : 0;
+}
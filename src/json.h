@@ -31,5 +31,6 @@ JsonObject *get_arguments(JsonObject * req);
 JsonObject *node_get_arguments(JsonNode * req);
 gdouble json_double_to_progress(JsonNode * n);
 gdouble json_node_really_get_double(JsonNode * node);
+guint64 json_node_digest(JsonNode * node);
 
 #endif                          /* JSON_H_ */
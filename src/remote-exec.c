@@ -56,25 +56,27 @@ static const char json_exceptions[] = { 0x7f, 0x80, 0x81, 0x82, 0x83, 0x84,
     0xfd, 0xfe, 0xff, '\0'      /* g_strescape() expects a NUL-terminated string */
 };
 
-static gchar *dump_json_value(JsonNode * node)
+static gchar *dump_value(const GValue * value)
 {
-    GValue value = G_VALUE_INIT;
     GString *buffer;
 
     buffer = g_string_new("");
 
-    json_node_get_value(node, &value);
-
-    switch (G_VALUE_TYPE(&value)) {
+    switch (G_VALUE_TYPE(value)) {
     case G_TYPE_INT64:
         g_string_append_printf(buffer, "%" G_GINT64_FORMAT,
-                               g_value_get_int64(&value));
+                               g_value_get_int64(value));
+        break;
+    case G_TYPE_UINT:
+        g_string_append_printf(buffer, "%u", g_value_get_uint(value));
         break;
     case G_TYPE_STRING:
         {
             gchar *tmp;
 
-            tmp = g_strescape(g_value_get_string(&value), json_exceptions);
+            tmp = g_strescape(g_value_get_string(value) ?
+                              g_value_get_string(value) : "",
+                              json_exceptions);
             g_string_append(buffer, tmp);
 
             g_free(tmp);
@@ -86,21 +88,122 @@ static gchar *dump_json_value(JsonNode * node)
 
             g_string_append(buffer,
                             g_ascii_dtostr(buf, sizeof(buf),
-                                           g_value_get_double(&value)));
+                                           g_value_get_double(value)));
         }
         break;
     case G_TYPE_BOOLEAN:
         g_string_append_printf(buffer, "%s",
-                               g_value_get_boolean(&value) ? "true" :
+                               g_value_get_boolean(value) ? "true" :
                                "false");
         break;
     default:
         break;
     }
 
+    return g_string_free(buffer, FALSE);
+}
+
+static gchar *dump_json_value(JsonNode * node)
+{
+    GValue value = G_VALUE_INIT;
+    gchar *result;
+
+    json_node_get_value(node, &value);
+    result = dump_value(&value);
     g_value_unset(&value);
 
-    return g_string_free(buffer, FALSE);
+    return result;
+}
+
+/* The core torrent fields, which are always polled, and the model column
+ * each is kept in as it came. Anything else is only in the JSON the model
+ * keeps for the torrent it has the detail of. */
+
+static const struct {
+    const gchar *field;
+    gint column;
+    gboolean boolean;
+} torrent_field_columns[] = {
+    {FIELD_ID, TORRENT_COLUMN_ID, FALSE},
+    {FIELD_NAME, TORRENT_COLUMN_NAME, FALSE},
+    {FIELD_HASH_STRING, TORRENT_COLUMN_HASH_STRING, FALSE},
+    {FIELD_DOWNLOAD_DIR, TORRENT_COLUMN_DOWNLOADDIR, FALSE},
+    {FIELD_ERROR, TORRENT_COLUMN_ERROR, FALSE},
+    {FIELD_ERROR_STRING, TORRENT_COLUMN_ERROR_STRING, FALSE},
+    {FIELD_RATEDOWNLOAD, TORRENT_COLUMN_DOWNSPEED, FALSE},
+    {FIELD_RATEUPLOAD, TORRENT_COLUMN_UPSPEED, FALSE},
+    {FIELD_BANDWIDTH_PRIORITY, TORRENT_COLUMN_BANDWIDTH_PRIORITY, FALSE},
+    {FIELD_PEERS_GETTING_FROM_US, TORRENT_COLUMN_PEERS_FROM_US, FALSE},
+    {FIELD_UPLOAD_LIMIT, TORRENT_COLUMN_UPLOAD_LIMIT, FALSE},
+    {FIELD_UPLOAD_LIMITED, TORRENT_COLUMN_UPLOAD_LIMITED, TRUE},
+    {FIELD_DOWNLOAD_LIMIT, TORRENT_COLUMN_DOWNLOAD_LIMIT, FALSE},
+    {FIELD_DOWNLOAD_LIMITED, TORRENT_COLUMN_DOWNLOAD_LIMITED, TRUE},
+    {FIELD_FILE_COUNT, TORRENT_COLUMN_FILECOUNT, FALSE},
+};
+
+static gchar *dump_torrent_field(GtkTreeModel * model, GtkTreeIter * iter,
+                                 const gchar * field)
+{
+    GValue value = G_VALUE_INIT;
+    JsonObject *json;
+    JsonNode *node;
+    gchar *result;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(torrent_field_columns); i++) {
+        if (g_strcmp0(torrent_field_columns[i].field, field))
+            continue;
+
+        gtk_tree_model_get_value(model, iter,
+                                 torrent_field_columns[i].column, &value);
+
+        if (torrent_field_columns[i].boolean) {
+            gboolean b = g_value_get_int64(&value) != 0;
+            g_value_unset(&value);
+            g_value_init(&value, G_TYPE_BOOLEAN);
+            g_value_set_boolean(&value, b);
+        }
+
+        result = dump_value(&value);
+        g_value_unset(&value);
+
+        return result;
+    }
+
+    gtk_tree_model_get(model, iter, TORRENT_COLUMN_JSON, &json, -1);
+
+    if (json && (node = json_object_get_member(json, field))
+        && JSON_NODE_HOLDS_VALUE(node))
+        return dump_json_value(node);
+
+    return NULL;
+}
+
+/* Where the torrent's data is. Only the detail has the files to tell a
+ * single file torrent from one with its own directory by. */
+
+static gchar *torrent_row_get_path(GtkTreeModel * model,
+                                   GtkTreeIter * iter, gboolean dir)
+{
+    JsonObject *json;
+    gchar *downloadDir, *name, *path;
+
+    gtk_tree_model_get(model, iter, TORRENT_COLUMN_JSON, &json, -1);
+
+    if (json)
+        return dir ? torrent_get_full_dir(json) :
+            torrent_get_full_path(json);
+
+    gtk_tree_model_get(model, iter, TORRENT_COLUMN_DOWNLOADDIR,
+                       &downloadDir, TORRENT_COLUMN_NAME, &name, -1);
+
+    path = dir ? g_strdup(downloadDir) :
+        g_strdup_printf("%s/%s", downloadDir, name);
+
+    g_free(downloadDir);
+    g_free(name);
+
+    return path;
 }
 
 gchar *build_remote_exec_cmd(TrgClient * tc, GtkTreeModel * model,
@@ -145,27 +248,20 @@ gchar *build_remote_exec_cmd(TrgClient * tc, GtkTreeModel * model,
                 GString *gs = g_string_new("");
                 GList *li;
                 GtkTreeIter iter;
-                JsonObject *json;
                 gchar *piece;
 
                 for (li = selection; li; li = g_list_next(li)) {
-                    piece = NULL;
                     gtk_tree_model_get_iter(model, &iter,
                                             (GtkTreePath *) li->data);
-                    gtk_tree_model_get(model, &iter, TORRENT_COLUMN_JSON,
-                                       &json, -1);
-                    if (json_object_has_member(json, id)) {
-                        replacement = json_object_get_member(json, id);
-                        if (JSON_NODE_HOLDS_VALUE(replacement)) {
-                            piece = dump_json_value(replacement);
-                        }
-                    }
+                    piece = dump_torrent_field(model, &iter, id);
 
                     if (!piece) {
                         if (!g_strcmp0(id, "full-dir")) {
-                            piece = torrent_get_full_dir(json);
+                            piece = torrent_row_get_path(model, &iter,
+                                                         TRUE);
                         } else if (!g_strcmp0(id, "full-path")) {
-                            piece = torrent_get_full_path(json);
+                            piece = torrent_row_get_path(model, &iter,
+                                                         FALSE);
                         }
                     }
 
@@ -151,11 +151,28 @@ JsonNode *torrent_remove(JsonArray * array, gboolean removeData)
     return root;
 }
 
-JsonNode *torrent_get(gint64 id)
+static void torrent_get_set_fields(JsonObject * args, guint64 fields)
+{
+    JsonArray *array = json_array_new();
+    guint i;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++)
+        if (fields & TORRENT_FIELD_BIT(i))
+            json_array_add_string_element(array,
+                                          torrent_field_get(i)->name);
+
+    json_object_set_array_member(args, PARAM_FIELDS, array);
+}
+
+/* The fields are a mask of TORRENT_FIELD_BIT()s, see
+ * torrent_fields_for_sets(). Daemons that can send the torrents as a table
+ * are asked to, which names each field once rather than per torrent.
+ */
+
+JsonNode *torrent_get(gint64 id, guint64 fields, gint64 rpcv)
 {
     JsonNode *root = base_request(METHOD_TORRENT_GET);
     JsonObject *args = node_get_arguments(root);
-    JsonArray *fields = json_array_new();
 
     if (id == TORRENT_GET_TAG_MODE_UPDATE) {
         json_object_set_string_member(args, PARAM_IDS,
@@ -166,59 +183,42 @@ JsonNode *torrent_get(gint64 id)
         json_object_set_array_member(args, PARAM_IDS, ids);
     }
 
-    json_array_add_string_element(fields, FIELD_ETA);
-    json_array_add_string_element(fields, FIELD_PEERS);
-    json_array_add_string_element(fields, FIELD_PEERSFROM);
-    json_array_add_string_element(fields, FIELD_FILES);
-    json_array_add_string_element(fields, FIELD_PEERS_SENDING_TO_US);
-    json_array_add_string_element(fields, FIELD_PEERS_GETTING_FROM_US);
-    json_array_add_string_element(fields, FIELD_WEB_SEEDS_SENDING_TO_US);
-    json_array_add_string_element(fields, FIELD_PEERS_CONNECTED);
-    json_array_add_string_element(fields, FIELD_HAVEVALID);
-    json_array_add_string_element(fields, FIELD_HAVEUNCHECKED);
-    json_array_add_string_element(fields, FIELD_RATEUPLOAD);
-    json_array_add_string_element(fields, FIELD_RATEDOWNLOAD);
-    json_array_add_string_element(fields, FIELD_STATUS);
-    json_array_add_string_element(fields, FIELD_ISFINISHED);
-    json_array_add_string_element(fields, FIELD_ISPRIVATE);
-    json_array_add_string_element(fields, FIELD_ADDED_DATE);
-    json_array_add_string_element(fields, FIELD_DOWNLOADEDEVER);
-    json_array_add_string_element(fields, FIELD_UPLOADEDEVER);
-    json_array_add_string_element(fields, FIELD_CORRUPTEVER);
-    json_array_add_string_element(fields, FIELD_SIZEWHENDONE);
-    json_array_add_string_element(fields, FIELD_QUEUE_POSITION);
-    json_array_add_string_element(fields, FIELD_ID);
-    json_array_add_string_element(fields, FIELD_NAME);
-    json_array_add_string_element(fields, FIELD_PERCENTDONE);
-    json_array_add_string_element(fields, FIELD_COMMENT);
-    json_array_add_string_element(fields, FIELD_TOTAL_SIZE);
-    json_array_add_string_element(fields, FIELD_METADATAPERCENTCOMPLETE);
-    json_array_add_string_element(fields, FIELD_LEFT_UNTIL_DONE);
-    json_array_add_string_element(fields, FIELD_ANNOUNCE_URL);
-    json_array_add_string_element(fields, FIELD_ERROR_STRING);
-    json_array_add_string_element(fields, FIELD_TRACKER_STATS);
-    json_array_add_string_element(fields, FIELD_DATE_CREATED);
-    json_array_add_string_element(fields, FIELD_DOWNLOAD_DIR);
-    json_array_add_string_element(fields, FIELD_CREATOR);
-    json_array_add_string_element(fields, FIELD_HASH_STRING);
-    json_array_add_string_element(fields, FIELD_DONE_DATE);
-    json_array_add_string_element(fields, FIELD_HONORS_SESSION_LIMITS);
-    json_array_add_string_element(fields, FIELD_UPLOAD_LIMIT);
-    json_array_add_string_element(fields, FIELD_UPLOAD_LIMITED);
-    json_array_add_string_element(fields, FIELD_DOWNLOAD_LIMIT);
-    json_array_add_string_element(fields, FIELD_DOWNLOAD_LIMITED);
-    json_array_add_string_element(fields, FIELD_BANDWIDTH_PRIORITY);
-    json_array_add_string_element(fields, FIELD_SEED_RATIO_LIMIT);
-    json_array_add_string_element(fields, FIELD_SEED_RATIO_MODE);
-    json_array_add_string_element(fields, FIELD_PEER_LIMIT);
-    json_array_add_string_element(fields, FIELD_ACTIVITY_DATE);
-    json_array_add_string_element(fields, FIELD_MAGNETLINK);
-    json_array_add_string_element(fields, FIELD_ERROR);
-    json_array_add_string_element(fields, FIELD_ERROR_STRING);
-    json_array_add_string_element(fields, FIELD_WANTED);
-    json_array_add_string_element(fields, FIELD_PRIORITIES);
-    json_array_add_string_element(fields, FIELD_RECHECK_PROGRESS);
-    json_object_set_array_member(args, PARAM_FIELDS, fields);
+    torrent_get_set_fields(args, fields);
+
+    if (torrent_get_use_table(rpcv))
+        json_object_set_string_member(args, PARAM_FORMAT, FORMAT_TABLE);
+
+    return root;
+}
+
+/* The same, for a list of torrents. Takes the array. */
+
+JsonNode *torrent_get_ids(JsonArray * ids, guint64 fields, gint64 rpcv)
+{
+    JsonNode *root = base_request(METHOD_TORRENT_GET);
+    JsonObject *args = node_get_arguments(root);
+
+    json_object_set_array_member(args, PARAM_IDS, ids);
+    torrent_get_set_fields(args, fields);
+
+    if (torrent_get_use_table(rpcv))
+        json_object_set_string_member(args, PARAM_FORMAT, FORMAT_TABLE);
+
+    return root;
+}
+
+/* Everything we know about a single torrent, for the notebook and the
+ * properties dialog. Tagged with the ID so callbacks know which it was.
+ */
+
+JsonNode *torrent_get_detail(gint64 id, gint64 rpcv)
+{
+    JsonNode *root = torrent_get(id,
+                                 torrent_fields_for_sets(TORRENT_FIELDS_LIST
+                                                         |
+                                                         TORRENT_FIELDS_DETAIL,
+                                                         rpcv), rpcv);
+    request_set_tag(root, id);
     return root;
 }
 
@@ -312,3 +312,52 @@ void request_set_tag_from_ids(JsonNode * req, JsonArray * ids)
         json_array_get_int_element(ids, 0) : TORRENT_GET_TAG_MODE_FULL;
     request_set_tag(req, id);
 }
+
+const gchar *request_get_method(JsonNode * req)
+{
+    return json_object_get_string_member(json_node_get_object(req),
+                                         PARAM_METHOD);
+}
+
+/* Whether the response to full, a torrent-get for every torrent, has
+ * everything the one to req, a torrent-get for some by id, would. */
+
+gboolean torrent_get_covers(JsonNode * full, JsonNode * req)
+{
+    JsonObject *fullArgs, *reqArgs;
+    JsonArray *fullFields, *reqFields;
+    JsonNode *ids;
+    guint i, j, n;
+
+    if (g_strcmp0(request_get_method(full), METHOD_TORRENT_GET)
+        || g_strcmp0(request_get_method(req), METHOD_TORRENT_GET))
+        return FALSE;
+
+    fullArgs = node_get_arguments(full);
+    reqArgs = node_get_arguments(req);
+    ids = json_object_get_member(reqArgs, PARAM_IDS);
+
+    if (json_object_has_member(fullArgs, PARAM_IDS) || !ids
+        || JSON_NODE_TYPE(ids) != JSON_NODE_ARRAY
+        || !json_object_has_member(fullArgs, PARAM_FIELDS)
+        || !json_object_has_member(reqArgs, PARAM_FIELDS))
+        return FALSE;
+
+    fullFields = json_object_get_array_member(fullArgs, PARAM_FIELDS);
+    reqFields = json_object_get_array_member(reqArgs, PARAM_FIELDS);
+    n = json_array_get_length(fullFields);
+
+    for (i = 0; i < json_array_get_length(reqFields); i++) {
+        const gchar *name = json_array_get_string_element(reqFields, i);
+
+        for (j = 0; j < n; j++)
+            if (!g_strcmp0(name,
+                           json_array_get_string_element(fullFields, j)))
+                break;
+
+        if (j == n)
+            return FALSE;
+    }
+
+    return TRUE;
+}
@@ -29,7 +29,9 @@ JsonNode *generic_request(gchar * method, JsonArray * array);
 
 JsonNode *session_set(void);
 JsonNode *session_get(void);
-JsonNode *torrent_get(gint64 id);
+JsonNode *torrent_get(gint64 id, guint64 fields, gint64 rpcv);
+JsonNode *torrent_get_ids(JsonArray * ids, guint64 fields, gint64 rpcv);
+JsonNode *torrent_get_detail(gint64 id, gint64 rpcv);
 JsonNode *torrent_set(JsonArray * array);
 JsonNode *torrent_pause(JsonArray * array);
 JsonNode *torrent_start(JsonArray * array);
@@ -52,5 +54,7 @@ JsonNode *torrent_start_now(JsonArray * array);
 
 void request_set_tag(JsonNode * req, gint64 tag);
 void request_set_tag_from_ids(JsonNode * req, JsonArray * ids);
+const gchar *request_get_method(JsonNode * req);
+gboolean torrent_get_covers(JsonNode * full, JsonNode * req);
 
 #endif                          /* REQUESTS_H_ */
@@ -49,7 +49,8 @@ enum {
     P_WEBSEEDSTOUS,
     P_PEERSTOUS,
     P_ETA,
-    P_JSON,
+    P_NAME,
+    P_ERROR_STRING,
     P_CONNECTED,
     P_FILECOUNT,
     P_BAR_HEIGHT,
@@ -114,7 +115,8 @@ struct TorrentCellRendererPrivate {
     gdouble metadataPercentComplete;
     gdouble ratio;
     gdouble seedRatioLimit;
-    gpointer json;
+    gchar *name;
+    gchar *errorString;
     TrgClient *client;
     GtkTreeView *owner;
     gboolean compact;
@@ -315,7 +317,7 @@ static void getStatusString(GString * gstr, TorrentCellRenderer * r)
             N_("Error: %s")
         };
         g_string_append_printf(gstr, _(fmt[priv->error]),
-                               torrent_get_errorstr(priv->json));
+                               priv->errorString ? priv->errorString : "");
     } else if ((priv->flags & TORRENT_FLAG_PAUSED)
                || (priv->flags & TORRENT_FLAG_WAITING_CHECK)
                || (priv->flags & TORRENT_FLAG_CHECKING)
@@ -424,7 +426,7 @@ get_size_compact(TorrentCellRenderer * cell,
     g_object_set(p->icon_renderer, "pixbuf", icon, NULL);
     gtr_cell_renderer_get_preferred_size(p->icon_renderer, widget, NULL,
                                          &icon_size);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->name,
                  "ellipsize", PANGO_ELLIPSIZE_NONE, "scale", 1.0, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
                                          &name_size);
@@ -476,7 +478,7 @@ get_size_full(TorrentCellRenderer * cell,
     g_object_set(p->icon_renderer, "pixbuf", icon, NULL);
     gtr_cell_renderer_get_preferred_size(p->icon_renderer, widget, NULL,
                                          &icon_size);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->name,
                  "weight", PANGO_WEIGHT_BOLD, "scale", 1.0, "ellipsize",
                  PANGO_ELLIPSIZE_NONE, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
@@ -626,8 +628,13 @@ static void torrent_cell_renderer_set_property(GObject * object,
     struct TorrentCellRendererPrivate *p = self->priv;
 
     switch (property_id) {
-    case P_JSON:
-        p->json = g_value_get_pointer(v);
+    case P_NAME:
+        g_free(p->name);
+        p->name = g_value_dup_string(v);
+        break;
+    case P_ERROR_STRING:
+        g_free(p->errorString);
+        p->errorString = g_value_dup_string(v);
         break;
     case P_STATUS:
         p->flags = g_value_get_uint(v);
@@ -728,6 +735,8 @@ static void torrent_cell_renderer_dispose(GObject * o)
     if (r && r->priv) {
         g_string_free(r->priv->gstr1, TRUE);
         g_string_free(r->priv->gstr2, TRUE);
+        g_free(r->priv->name);
+        g_free(r->priv->errorString);
         g_object_unref(G_OBJECT(r->priv->text_renderer));
         g_object_unref(G_OBJECT(r->priv->progress_renderer));
         g_object_unref(G_OBJECT(r->priv->icon_renderer));
@@ -752,10 +761,17 @@ torrent_cell_renderer_class_init(TorrentCellRendererClass * klass)
     gobject_class->get_property = torrent_cell_renderer_get_property;
     gobject_class->dispose = torrent_cell_renderer_dispose;
 
-    g_object_class_install_property(gobject_class, P_JSON,
-                                    g_param_spec_pointer("json", NULL,
-                                                         "json",
-                                                         G_PARAM_READWRITE));
+    g_object_class_install_property(gobject_class, P_NAME,
+                                    g_param_spec_string("name", NULL,
+                                                        "name", NULL,
+                                                        G_PARAM_READWRITE));
+
+    g_object_class_install_property(gobject_class, P_ERROR_STRING,
+                                    g_param_spec_string("error-string",
+                                                        NULL,
+                                                        "error-string",
+                                                        NULL,
+                                                        G_PARAM_READWRITE));
 
     g_object_class_install_property(gobject_class, P_CLIENT,
                                     g_param_spec_pointer("client", NULL,
@@ -987,7 +1003,7 @@ render_compact(TorrentCellRenderer * cell,
     gtr_cell_renderer_get_preferred_size(p->icon_renderer, widget, NULL,
                                          &size);
     icon_area.width = size.width;
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->name,
                  "ellipsize", PANGO_ELLIPSIZE_NONE, "scale", 1.0, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
                                          &size);
@@ -1023,7 +1039,7 @@ render_compact(TorrentCellRenderer * cell,
                  FOREGROUND_COLOR_KEY, &text_color, NULL);
     gtr_cell_renderer_render(p->text_renderer, window, widget, &stat_area,
                              flags);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->name,
                  "scale", 1.0, FOREGROUND_COLOR_KEY, &text_color, NULL);
     gtr_cell_renderer_render(p->text_renderer, window, widget, &name_area,
                              flags);
@@ -1074,7 +1090,7 @@ render_full(TorrentCellRenderer * cell,
                                          &size);
     icon_area.width = size.width;
     icon_area.height = size.height;
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->name,
                  "weight", PANGO_WEIGHT_BOLD, "ellipsize",
                  PANGO_ELLIPSIZE_NONE, "scale", 1.0, NULL);
     gtr_cell_renderer_get_preferred_size(p->text_renderer, widget, NULL,
@@ -1137,7 +1153,7 @@ render_full(TorrentCellRenderer * cell,
                  NULL);
     gtr_cell_renderer_render(p->icon_renderer, window, widget, &icon_area,
                              flags);
-    g_object_set(p->text_renderer, "text", torrent_get_name(p->json),
+    g_object_set(p->text_renderer, "text", p->name,
                  "scale", 1.0, FOREGROUND_COLOR_KEY, &text_color,
                  "ellipsize", PANGO_ELLIPSIZE_END, "weight",
                  PANGO_WEIGHT_BOLD, NULL);
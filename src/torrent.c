@@ -21,6 +21,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include <glib-object.h>
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
@@ -34,6 +36,855 @@
 
 /* Just some functions to get fields out of the torrent object. */
 
+#define C (TORRENT_FIELDS_LIST | TORRENT_FIELDS_CORE)
+#define L TORRENT_FIELDS_LIST
+#define D TORRENT_FIELDS_DETAIL
+
+/* Every field we ask torrent-get for, and the request(s) it belongs to.
+ * Anything the torrent list, cell renderer, state selector or status bar
+ * reads must be in the list set. Core fields feed the torrent flags,
+ * filters, menus and remote commands, so they're always polled. The detail
+ * request asks for both sets.
+ */
+static const trg_torrent_field torrent_fields[TORRENT_FIELD_COUNT] = {
+    [TORRENT_FIELD_ID] = {FIELD_ID, C, 0},
+    [TORRENT_FIELD_NAME] = {FIELD_NAME, C, 0},
+    [TORRENT_FIELD_STATUS] = {FIELD_STATUS, C, 0},
+    [TORRENT_FIELD_ERROR] = {FIELD_ERROR, C, 0},
+    [TORRENT_FIELD_ERROR_STRING] = {FIELD_ERROR_STRING, C, 0},
+    [TORRENT_FIELD_RATEDOWNLOAD] = {FIELD_RATEDOWNLOAD, C, 0},
+    [TORRENT_FIELD_RATEUPLOAD] = {FIELD_RATEUPLOAD, C, 0},
+    [TORRENT_FIELD_ETA] = {FIELD_ETA, L, 0},
+    [TORRENT_FIELD_SIZEWHENDONE] = {FIELD_SIZEWHENDONE, L, 0},
+    [TORRENT_FIELD_TOTAL_SIZE] = {FIELD_TOTAL_SIZE, L, 0},
+    [TORRENT_FIELD_PERCENTDONE] = {FIELD_PERCENTDONE, C, 0},
+    [TORRENT_FIELD_RECHECK_PROGRESS] = {FIELD_RECHECK_PROGRESS, C, 0},
+    [TORRENT_FIELD_METADATAPERCENTCOMPLETE] =
+        {FIELD_METADATAPERCENTCOMPLETE, L, 0},
+    [TORRENT_FIELD_HAVEVALID] = {FIELD_HAVEVALID, L, 0},
+    [TORRENT_FIELD_HAVEUNCHECKED] = {FIELD_HAVEUNCHECKED, L, 0},
+    [TORRENT_FIELD_UPLOADEDEVER] = {FIELD_UPLOADEDEVER, L, 0},
+    [TORRENT_FIELD_DOWNLOADEDEVER] = {FIELD_DOWNLOADEDEVER, L, 0},
+    [TORRENT_FIELD_LEFT_UNTIL_DONE] = {FIELD_LEFT_UNTIL_DONE, C, 0},
+    [TORRENT_FIELD_ADDED_DATE] = {FIELD_ADDED_DATE, L, 0},
+    [TORRENT_FIELD_DONE_DATE] = {FIELD_DONE_DATE, L, 0},
+    [TORRENT_FIELD_ACTIVITY_DATE] = {FIELD_ACTIVITY_DATE, L, 0},
+    [TORRENT_FIELD_DOWNLOAD_DIR] = {FIELD_DOWNLOAD_DIR, C, 0},
+    [TORRENT_FIELD_QUEUE_POSITION] = {FIELD_QUEUE_POSITION, L, 0},
+    [TORRENT_FIELD_BANDWIDTH_PRIORITY] = {FIELD_BANDWIDTH_PRIORITY, C, 0},
+    [TORRENT_FIELD_SEED_RATIO_MODE] = {FIELD_SEED_RATIO_MODE, L, 0},
+    [TORRENT_FIELD_SEED_RATIO_LIMIT] = {FIELD_SEED_RATIO_LIMIT, L, 0},
+    [TORRENT_FIELD_PEERS_CONNECTED] = {FIELD_PEERS_CONNECTED, L, 0},
+    [TORRENT_FIELD_PEERS_SENDING_TO_US] =
+        {FIELD_PEERS_SENDING_TO_US, L, 0},
+    [TORRENT_FIELD_PEERS_GETTING_FROM_US] =
+        {FIELD_PEERS_GETTING_FROM_US, C, 0},
+    [TORRENT_FIELD_WEB_SEEDS_SENDING_TO_US] =
+        {FIELD_WEB_SEEDS_SENDING_TO_US, L, 0},
+    [TORRENT_FIELD_PEERSFROM] = {FIELD_PEERSFROM, L, 0},
+    [TORRENT_FIELD_TRACKER_STATS] = {FIELD_TRACKER_STATS, L, 0},
+    [TORRENT_FIELD_UPLOAD_LIMIT] = {FIELD_UPLOAD_LIMIT, C, 0},
+    [TORRENT_FIELD_UPLOAD_LIMITED] = {FIELD_UPLOAD_LIMITED, C, 0},
+    [TORRENT_FIELD_DOWNLOAD_LIMIT] = {FIELD_DOWNLOAD_LIMIT, C, 0},
+    [TORRENT_FIELD_DOWNLOAD_LIMITED] = {FIELD_DOWNLOAD_LIMITED, C, 0},
+    [TORRENT_FIELD_FILE_COUNT] =
+        {FIELD_FILE_COUNT, C, FILE_COUNT_RPC_VERSION},
+    /* the smallest per-file array, to count files without file-count */
+    [TORRENT_FIELD_PRIORITIES] =
+        {FIELD_PRIORITIES, TORRENT_FIELDS_LIST_LEGACY | D, 0},
+    [TORRENT_FIELD_FILES] = {FIELD_FILES, D, 0},
+    [TORRENT_FIELD_WANTED] = {FIELD_WANTED, D, 0},
+    [TORRENT_FIELD_PEERS] = {FIELD_PEERS, D, 0},
+    [TORRENT_FIELD_COMMENT] = {FIELD_COMMENT, D, 0},
+    [TORRENT_FIELD_CREATOR] = {FIELD_CREATOR, D, 0},
+    [TORRENT_FIELD_DATE_CREATED] = {FIELD_DATE_CREATED, D, 0},
+    /* commonly used by remote commands, which only have the list */
+    [TORRENT_FIELD_HASH_STRING] = {FIELD_HASH_STRING, C, 0},
+    [TORRENT_FIELD_MAGNETLINK] = {FIELD_MAGNETLINK, D, 0},
+    [TORRENT_FIELD_CORRUPTEVER] = {FIELD_CORRUPTEVER, D, 0},
+    [TORRENT_FIELD_HONORS_SESSION_LIMITS] =
+        {FIELD_HONORS_SESSION_LIMITS, D, 0},
+    [TORRENT_FIELD_PEER_LIMIT] = {FIELD_PEER_LIMIT, D, 0},
+    [TORRENT_FIELD_ISPRIVATE] = {FIELD_ISPRIVATE, D, 0},
+    [TORRENT_FIELD_ISFINISHED] = {FIELD_ISFINISHED, D, 0},
+    [TORRENT_FIELD_ANNOUNCE_URL] = {FIELD_ANNOUNCE_URL, D, 0},
+};
+
+#undef C
+#undef L
+#undef D
+
+const trg_torrent_field *torrent_field_get(guint field)
+{
+    g_return_val_if_fail(field < TORRENT_FIELD_COUNT, NULL);
+    return &torrent_fields[field];
+}
+
+guint64 torrent_fields_for_sets(guint sets, gint64 rpcv)
+{
+    guint64 fields = 0;
+    guint i;
+
+    if ((sets & (TORRENT_FIELDS_LIST | TORRENT_FIELDS_CORE))
+        && rpcv < FILE_COUNT_RPC_VERSION)
+        sets |= TORRENT_FIELDS_LIST_LEGACY;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++) {
+        const trg_torrent_field *field = &torrent_fields[i];
+        if ((field->sets & sets) && rpcv >= field->minRpcVersion)
+            fields |= TORRENT_FIELD_BIT(i);
+    }
+
+    return fields;
+}
+
+gboolean torrent_get_use_table(gint64 rpcv)
+{
+    return rpcv >= TABLE_FORMAT_RPC_VERSION;
+}
+
+static gint torrent_field_lookup(const gchar * name)
+{
+    guint i;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++)
+        if (!g_strcmp0(torrent_fields[i].name, name))
+            return i;
+
+    return -1;
+}
+
+/* With the table format, the first element of the torrents array holds the
+ * field names and every following one is a row of values in that order.
+ * Work out where each field is once, rather than per torrent. Otherwise
+ * it's an array of objects, one per torrent.
+ */
+
+void torrents_reader_init(trg_torrents_reader * reader, JsonObject * args)
+{
+    JsonNode *first;
+    guint i, n;
+
+    reader->torrents = get_torrents(args);
+    reader->header = NULL;
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++)
+        reader->columns[i] = -1;
+
+    if (json_array_get_length(reader->torrents) < 1)
+        return;
+
+    first = json_array_get_element(reader->torrents, 0);
+    if (!JSON_NODE_HOLDS_ARRAY(first))
+        return;
+
+    reader->header = json_node_get_array(first);
+    n = json_array_get_length(reader->header);
+
+    for (i = 0; i < n; i++) {
+        gint field = torrent_field_lookup(json_array_get_string_element
+                                          (reader->header, i));
+        if (field >= 0)
+            reader->columns[field] = i;
+    }
+}
+
+guint torrents_reader_get_length(trg_torrents_reader * reader)
+{
+    guint length = json_array_get_length(reader->torrents);
+
+    if (reader->header)
+        return length - 1;
+    else
+        return length;
+}
+
+/* Fills in values for the i'th torrent. They point into the reader's
+ * torrents array, so they live as long as it does.
+ */
+
+void torrents_reader_get(trg_torrents_reader * reader, guint i,
+                         trg_torrent_values * values)
+{
+    JsonObject *t;
+    JsonArray *row;
+    guint j, n;
+
+    memset(values, 0, sizeof(trg_torrent_values));
+
+    if (!reader->header) {
+        t = json_array_get_object_element(reader->torrents, i);
+        for (j = 0; j < TORRENT_FIELD_COUNT; j++)
+            values->nodes[j] =
+                json_object_get_member(t, torrent_fields[j].name);
+        return;
+    }
+
+    row = json_array_get_array_element(reader->torrents, i + 1);
+    n = json_array_get_length(row);
+
+    for (j = 0; j < TORRENT_FIELD_COUNT; j++) {
+        gint column = reader->columns[j];
+        if (column >= 0 && (guint) column < n)
+            values->nodes[j] = json_array_get_element(row, column);
+    }
+}
+
+/* The i'th torrent as an object, with a new reference. A table row is
+ * turned into one, so only do this for a torrent something needs the
+ * object of.
+ */
+
+JsonObject *torrents_reader_get_object(trg_torrents_reader * reader,
+                                       guint i,
+                                       const trg_torrent_values * values)
+{
+    JsonObject *t;
+    guint j;
+
+    if (!reader->header)
+        return json_object_ref(json_array_get_object_element
+                               (reader->torrents, i));
+
+    t = json_object_new();
+
+    for (j = 0; j < TORRENT_FIELD_COUNT; j++)
+        if (values->nodes[j])
+            json_object_set_member(t, torrent_fields[j].name,
+                                   json_node_copy(values->nodes[j]));
+
+    return t;
+}
+
+gint64 torrent_values_get_int(const trg_torrent_values * v, guint field)
+{
+    JsonNode *node = v->nodes[field];
+    return node ? json_node_get_int(node) : 0;
+}
+
+gdouble torrent_values_get_double(const trg_torrent_values * v,
+                                  guint field)
+{
+    JsonNode *node = v->nodes[field];
+    return node ? json_node_really_get_double(node) : 0.0;
+}
+
+gboolean torrent_values_get_boolean(const trg_torrent_values * v,
+                                    guint field)
+{
+    JsonNode *node = v->nodes[field];
+    return node ? json_node_get_boolean(node) : FALSE;
+}
+
+const gchar *torrent_values_get_string(const trg_torrent_values * v,
+                                       guint field)
+{
+    JsonNode *node = v->nodes[field];
+    return node ? json_node_get_string(node) : NULL;
+}
+
+JsonArray *torrent_values_get_array(const trg_torrent_values * v,
+                                    guint field)
+{
+    JsonNode *node = v->nodes[field];
+    return node && JSON_NODE_HOLDS_ARRAY(node) ?
+        json_node_get_array(node) : NULL;
+}
+
+JsonObject *torrent_values_get_object(const trg_torrent_values * v,
+                                      guint field)
+{
+    JsonNode *node = v->nodes[field];
+    return node && JSON_NODE_HOLDS_OBJECT(node) ?
+        json_node_get_object(node) : NULL;
+}
+
+gint64 torrent_values_get_file_count(const trg_torrent_values * v)
+{
+    JsonArray *files;
+
+    if (torrent_values_has(v, TORRENT_FIELD_FILE_COUNT))
+        return torrent_values_get_int(v, TORRENT_FIELD_FILE_COUNT);
+    else if ((files = torrent_values_get_array(v, TORRENT_FIELD_FILES)))
+        return json_array_get_length(files);
+    else if ((files = torrent_values_get_array(v, TORRENT_FIELD_PRIORITIES)))
+        return json_array_get_length(files);
+    else
+        return 0;
+}
+
+static GRegex *torrent_records_host_regex(void)
+{
+    static gsize init = 0;
+    static GRegex *rx = NULL;
+
+    if (g_once_init_enter(&init)) {
+        rx = trg_uri_host_regex_new();
+        g_once_init_leave(&init, 1);
+    }
+
+    return rx;
+}
+
+static void
+torrent_record_fill(trg_torrent_record * r, const trg_torrent_values * v)
+{
+    JsonArray *trackerStats;
+    JsonObject *pf;
+    guint i;
+
+    memset(r, 0, sizeof(trg_torrent_record));
+
+    for (i = 0; i < TORRENT_FIELD_COUNT; i++)
+        if (torrent_values_has(v, i))
+            r->fields |= TORRENT_FIELD_BIT(i);
+
+    r->changed = r->fields;
+
+    r->id = torrent_values_get_int(v, TORRENT_FIELD_ID);
+    r->status = torrent_values_get_int(v, TORRENT_FIELD_STATUS);
+    r->error = torrent_values_get_int(v, TORRENT_FIELD_ERROR);
+    r->rateDownload = torrent_values_get_int(v, TORRENT_FIELD_RATEDOWNLOAD);
+    r->rateUpload = torrent_values_get_int(v, TORRENT_FIELD_RATEUPLOAD);
+    r->eta = torrent_values_get_int(v, TORRENT_FIELD_ETA);
+    r->sizeWhenDone = torrent_values_get_int(v, TORRENT_FIELD_SIZEWHENDONE);
+    r->totalSize = torrent_values_get_int(v, TORRENT_FIELD_TOTAL_SIZE);
+    r->haveValid = torrent_values_get_int(v, TORRENT_FIELD_HAVEVALID);
+    r->haveUnchecked =
+        torrent_values_get_int(v, TORRENT_FIELD_HAVEUNCHECKED);
+    r->uploadedEver = torrent_values_get_int(v, TORRENT_FIELD_UPLOADEDEVER);
+    r->downloadedEver =
+        torrent_values_get_int(v, TORRENT_FIELD_DOWNLOADEDEVER);
+    r->leftUntilDone =
+        torrent_values_get_int(v, TORRENT_FIELD_LEFT_UNTIL_DONE);
+    r->addedDate = torrent_values_get_int(v, TORRENT_FIELD_ADDED_DATE);
+    r->doneDate = torrent_values_get_int(v, TORRENT_FIELD_DONE_DATE);
+    r->activityDate = torrent_values_get_int(v, TORRENT_FIELD_ACTIVITY_DATE);
+    r->bandwidthPriority =
+        torrent_values_get_int(v, TORRENT_FIELD_BANDWIDTH_PRIORITY);
+    r->seedRatioMode =
+        torrent_values_get_int(v, TORRENT_FIELD_SEED_RATIO_MODE);
+    r->peersConnected =
+        torrent_values_get_int(v, TORRENT_FIELD_PEERS_CONNECTED);
+    r->peersSendingToUs =
+        torrent_values_get_int(v, TORRENT_FIELD_PEERS_SENDING_TO_US);
+    r->peersGettingFromUs =
+        torrent_values_get_int(v, TORRENT_FIELD_PEERS_GETTING_FROM_US);
+    r->webseedsSendingToUs =
+        torrent_values_get_int(v, TORRENT_FIELD_WEB_SEEDS_SENDING_TO_US);
+    r->fileCount = torrent_values_get_file_count(v);
+    r->percentDone =
+        torrent_values_get_double(v, TORRENT_FIELD_PERCENTDONE) * 100.0;
+    r->recheckProgress =
+        torrent_values_get_double(v, TORRENT_FIELD_RECHECK_PROGRESS) * 100.0;
+    r->seedRatioLimit =
+        torrent_values_get_double(v, TORRENT_FIELD_SEED_RATIO_LIMIT);
+    r->uploadLimit = torrent_values_get_int(v, TORRENT_FIELD_UPLOAD_LIMIT);
+    r->downloadLimit =
+        torrent_values_get_int(v, TORRENT_FIELD_DOWNLOAD_LIMIT);
+    r->uploadLimited =
+        torrent_values_get_boolean(v, TORRENT_FIELD_UPLOAD_LIMITED);
+    r->downloadLimited =
+        torrent_values_get_boolean(v, TORRENT_FIELD_DOWNLOAD_LIMITED);
+    r->name = torrent_values_get_string(v, TORRENT_FIELD_NAME);
+    r->errorString =
+        torrent_values_get_string(v, TORRENT_FIELD_ERROR_STRING);
+    r->hashString = torrent_values_get_string(v, TORRENT_FIELD_HASH_STRING);
+
+    /* These two cope with old daemons not having them. */
+    r->metadataPercentComplete =
+        torrent_values_has(v, TORRENT_FIELD_METADATAPERCENTCOMPLETE) ?
+        torrent_values_get_double(v,
+                                  TORRENT_FIELD_METADATAPERCENTCOMPLETE) *
+        100.0 : 100.0;
+    r->queuePosition =
+        torrent_values_has(v, TORRENT_FIELD_QUEUE_POSITION) ?
+        torrent_values_get_int(v, TORRENT_FIELD_QUEUE_POSITION) : -1;
+
+    /* The same few directories come up again and again. */
+    rm_trailing_slashes((gchar *)
+                        torrent_values_get_string(v,
+                                                  TORRENT_FIELD_DOWNLOAD_DIR));
+    r->downloadDir =
+        g_intern_string(torrent_values_get_string
+                        (v, TORRENT_FIELD_DOWNLOAD_DIR));
+
+    if ((pf = torrent_values_get_object(v, TORRENT_FIELD_PEERSFROM))) {
+        r->fromPex = peerfrom_get_pex(pf);
+        r->fromDht = peerfrom_get_dht(pf);
+        r->fromTrackers = peerfrom_get_trackers(pf);
+        r->fromLtep = peerfrom_get_ltep(pf);
+        r->fromResume = peerfrom_get_resume(pf);
+        r->fromIncoming = peerfrom_get_incoming(pf);
+        r->fromLpd = peerfrom_get_lpd(pf);
+    }
+
+    trackerStats = torrent_values_get_array(v, TORRENT_FIELD_TRACKER_STATS);
+    if (trackerStats) {
+        guint n = json_array_get_length(trackerStats);
+        guint hosts = 0;
+
+        r->trackerHosts = g_new0(const gchar *, n + 1);
+
+        for (i = 0; i < n; i++) {
+            JsonObject *tracker =
+                json_array_get_object_element(trackerStats, i);
+            gchar *announceHost =
+                trg_gregex_get_first(torrent_records_host_regex(),
+                                     tracker_stats_get_announce(tracker));
+
+            if (announceHost) {
+                const gchar *interned = g_intern_string(announceHost);
+                guint j;
+
+                for (j = 0; j < hosts && r->trackerHosts[j] != interned;
+                     j++);
+
+                if (j == hosts)
+                    r->trackerHosts[hosts++] = interned;
+
+                g_free(announceHost);
+            }
+
+            if (i == 0) {
+                gchar *host =
+                    trg_gregex_get_first(torrent_records_host_regex(),
+                                         tracker_stats_get_host(tracker));
+                r->trackerHost = g_intern_string(host);
+                g_free(host);
+            }
+
+            r->seeders += tracker_stats_get_seeder_count(tracker);
+            r->leechers += tracker_stats_get_leecher_count(tracker);
+            r->downloads += tracker_stats_get_download_count(tracker);
+        }
+    }
+}
+
+void trg_torrent_records_free(gpointer data)
+{
+    trg_torrent_records *records = (trg_torrent_records *) data;
+    guint i;
+
+    for (i = 0; i < records->torrents->len; i++) {
+        trg_torrent_record *r =
+            &g_array_index(records->torrents, trg_torrent_record, i);
+        if (r->json)
+            json_object_unref(r->json);
+        g_free(r->trackerHosts);
+        g_free(r->digests);
+    }
+
+    g_array_free(records->torrents, TRUE);
+
+    if (records->response)
+        json_array_unref(records->response);
+
+    if (records->removed)
+        g_array_free(records->removed, TRUE);
+
+    g_free(records);
+}
+
+/* The records for the torrents in ids, for a request by id that a full
+ * torrent-get answered. The response and objects are shared by
+ * reference, so either can be freed first, and there's nothing removed,
+ * which a request by id isn't told about. */
+
+trg_torrent_records *trg_torrent_records_subset(trg_torrent_records *
+                                                records, JsonArray * ids)
+{
+    trg_torrent_records *subset = g_new0(trg_torrent_records, 1);
+    GHashTable *wanted = g_hash_table_new(g_int64_hash, g_int64_equal);
+    gint64 *idv;
+    guint i, n = json_array_get_length(ids);
+
+    idv = g_new(gint64, n);
+    for (i = 0; i < n; i++) {
+        idv[i] = json_array_get_int_element(ids, i);
+        g_hash_table_add(wanted, &idv[i]);
+    }
+
+    subset->torrents = g_array_sized_new(FALSE, FALSE,
+                                         sizeof(trg_torrent_record), n);
+    subset->response = records->response ?
+        json_array_ref(records->response) : NULL;
+    subset->connid = records->connid;
+    subset->serial = records->serial;
+
+    for (i = 0; i < records->torrents->len; i++) {
+        trg_torrent_record r =
+            g_array_index(records->torrents, trg_torrent_record, i);
+
+        if (!g_hash_table_contains(wanted, &r.id))
+            continue;
+
+        if (r.json)
+            json_object_ref(r.json);
+
+        if (r.trackerHosts) {
+            const gchar **hosts = r.trackerHosts;
+            gsize size = (g_strv_length((gchar **) hosts) + 1) *
+                sizeof(gchar *);
+
+            r.trackerHosts = g_malloc(size);
+            memcpy(r.trackerHosts, hosts, size);
+        }
+
+        if (r.digests) {
+            guint64 *digests = r.digests;
+
+            r.digests = g_new(guint64, TORRENT_FIELD_COUNT);
+            memcpy(r.digests, digests,
+                   TORRENT_FIELD_COUNT * sizeof(guint64));
+        }
+
+        g_array_append_val(subset->torrents, r);
+    }
+
+    g_hash_table_destroy(wanted);
+    g_free(idv);
+
+    return subset;
+}
+
+typedef struct {
+    gint64 id;
+    guint version;
+    guint seen;
+    guint64 fields;
+    guint64 digests[TORRENT_FIELD_COUNT];
+} trg_shadow_torrent;
+
+struct _trg_torrents_shadow {
+    GMutex lock;
+    GHashTable *torrents;
+    gint connid;
+    guint serial;
+    gint64 rpcv;
+    gint64 detailId;
+};
+
+trg_torrents_shadow *trg_torrents_shadow_new(void)
+{
+    trg_torrents_shadow *shadow = g_new0(trg_torrents_shadow, 1);
+
+    g_mutex_init(&shadow->lock);
+    shadow->detailId = -1;
+    shadow->torrents = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                             NULL, g_free);
+
+    return shadow;
+}
+
+void trg_torrents_shadow_free(trg_torrents_shadow * shadow)
+{
+    g_hash_table_destroy(shadow->torrents);
+    g_mutex_clear(&shadow->lock);
+    g_free(shadow);
+}
+
+/* The daemon's RPC version, for the flags and status the records are
+ * given. Set it for a new connection before the first torrent-get. */
+
+void trg_torrents_shadow_set_rpc_version(trg_torrents_shadow * shadow,
+                                         gint64 rpcv)
+{
+    g_mutex_lock(&shadow->lock);
+    shadow->rpcv = rpcv;
+    g_mutex_unlock(&shadow->lock);
+}
+
+static gint64 trg_torrents_shadow_get_rpc_version(trg_torrents_shadow *
+                                                  shadow)
+{
+    gint64 rpcv;
+
+    g_mutex_lock(&shadow->lock);
+    rpcv = shadow->rpcv;
+    g_mutex_unlock(&shadow->lock);
+
+    return rpcv;
+}
+
+/* The torrent the model keeps the detail of, -1 for none. Its records are
+ * given an object even from a list poll, for the detail to be carried
+ * over into. */
+
+void trg_torrents_shadow_set_detail_id(trg_torrents_shadow * shadow,
+                                       gint64 id)
+{
+    g_mutex_lock(&shadow->lock);
+    shadow->detailId = id;
+    g_mutex_unlock(&shadow->lock);
+}
+
+static gint64 trg_torrents_shadow_get_detail_id(trg_torrents_shadow *
+                                                shadow)
+{
+    gint64 id;
+
+    g_mutex_lock(&shadow->lock);
+    id = shadow->detailId;
+    g_mutex_unlock(&shadow->lock);
+
+    return id;
+}
+
+/* Work out which fields of each record differ from what the model was
+ * last given for the torrent, by comparing digests of them, worked out
+ * beforehand with TORRENT_FIELD_COUNT for each record. A full list
+ * (no ids in the request) also tells us what's gone, which the model used
+ * to find by walking every row. Nothing here changes what the shadow
+ * holds, that waits for trg_torrents_shadow_commit(), so a response that
+ * is parsed but never applied doesn't leave the shadow ahead of the model.
+ */
+
+static void
+trg_torrents_shadow_diff(trg_torrents_shadow * shadow, trg_request * req,
+                         trg_torrent_records * records,
+                         const guint64 * allDigests)
+{
+    JsonObject *reqArgs = node_get_arguments(req->node);
+    gboolean full = !reqArgs || !json_object_has_member(reqArgs, PARAM_IDS);
+    const guint64 *digests;
+    trg_shadow_torrent *entry;
+    GHashTableIter hiter;
+    gboolean current;
+    guint i, j;
+
+    g_mutex_lock(&shadow->lock);
+
+    /* The shadow is still for an older connection until this (or a later
+     * response for the new one) is committed, so compare against nothing. */
+    current = req->connid == shadow->connid;
+
+    records->connid = req->connid;
+    records->serial = ++shadow->serial;
+
+    for (i = 0; i < records->torrents->len; i++) {
+        trg_torrent_record *r =
+            &g_array_index(records->torrents, trg_torrent_record, i);
+
+        entry = current ? g_hash_table_lookup(shadow->torrents, &r->id) :
+            NULL;
+
+        r->changed = 0;
+        r->version = records->serial;
+        digests = &allDigests[i * TORRENT_FIELD_COUNT];
+
+        for (j = 0; j < TORRENT_FIELD_COUNT; j++) {
+            guint64 bit = TORRENT_FIELD_BIT(j);
+
+            if (!(r->fields & bit))
+                continue;
+
+            if (!entry || !(entry->fields & bit)
+                || entry->digests[j] != digests[j])
+                r->changed |= bit;
+        }
+
+        /* The model only keeps the detail for one torrent, so it needs
+         * to see every detail response, even one it's seen before. */
+        if (torrent_record_has(r, TORRENT_FIELD_FILES))
+            r->changed = r->fields;
+
+        if (r->changed) {
+            r->digests = g_new(guint64, TORRENT_FIELD_COUNT);
+            memcpy(r->digests, digests,
+                   TORRENT_FIELD_COUNT * sizeof(guint64));
+        }
+
+        if (entry)
+            entry->seen = records->serial;
+    }
+
+    if (full && current) {
+        g_hash_table_iter_init(&hiter, shadow->torrents);
+        while (g_hash_table_iter_next(&hiter, NULL, (gpointer *) & entry)) {
+            if (entry->seen == records->serial)
+                continue;
+
+            if (!records->removed)
+                records->removed =
+                    g_array_new(FALSE, FALSE, sizeof(gint64));
+
+            g_array_append_val(records->removed, entry->id);
+        }
+    }
+
+    g_mutex_unlock(&shadow->lock);
+}
+
+/* Called by the model as it applies records, so the shadow only ever
+ * holds what the model was actually given. A record older than the last
+ * one applied for its torrent (a slow response delivered after a quicker,
+ * later one), or from the same response, is stale: its changed fields
+ * are cleared and it isn't committed. The model rejects it by its version
+ * column too. Returns
+ * FALSE for records from before a reconnect, which shouldn't be applied
+ * at all.
+ */
+
+gboolean trg_torrents_shadow_commit(trg_torrents_shadow * shadow,
+                                    trg_torrent_records * records)
+{
+    trg_shadow_torrent *entry;
+    guint i, j;
+
+    /* Not diffed, nothing to commit. */
+    if (!records->serial)
+        return TRUE;
+
+    g_mutex_lock(&shadow->lock);
+
+    if (records->connid < shadow->connid) {
+        g_mutex_unlock(&shadow->lock);
+        return FALSE;
+    }
+
+    if (records->connid != shadow->connid) {
+        g_hash_table_remove_all(shadow->torrents);
+        shadow->connid = records->connid;
+    }
+
+    for (i = 0; i < records->torrents->len; i++) {
+        trg_torrent_record *r =
+            &g_array_index(records->torrents, trg_torrent_record, i);
+
+        entry = g_hash_table_lookup(shadow->torrents, &r->id);
+        if (!entry) {
+            entry = g_new0(trg_shadow_torrent, 1);
+            entry->id = r->id;
+            g_hash_table_insert(shadow->torrents, &entry->id, entry);
+        } else if (r->version <= entry->version) {
+            r->changed = 0;
+            continue;
+        }
+
+        entry->version = r->version;
+
+        for (j = 0; r->changed && j < TORRENT_FIELD_COUNT; j++) {
+            guint64 bit = TORRENT_FIELD_BIT(j);
+
+            if (r->changed & bit) {
+                entry->fields |= bit;
+                entry->digests[j] = r->digests[j];
+            }
+        }
+    }
+
+    if (records->removed) {
+        for (i = 0; i < records->removed->len; i++)
+            g_hash_table_remove(shadow->torrents,
+                                &g_array_index(records->removed, gint64,
+                                               i));
+    }
+
+    g_mutex_unlock(&shadow->lock);
+
+    return TRUE;
+}
+
+/* Run on the thread that received a successful torrent-get response, see
+ * dispatch_async_parsed(). Turns the torrents into records, which hold
+ * the torrents array, and drops it from the response. Only a detail
+ * response, or the torrent the model keeps the detail of, is made into an
+ * object. With a shadow as the parse_data, the records are also compared
+ * against the previous response.
+ */
+
+void torrents_response_parse(trg_request * req, trg_response * response)
+{
+    trg_torrents_shadow *shadow = (trg_torrents_shadow *) req->parse_data;
+    trg_torrent_records *records;
+    trg_torrents_reader reader;
+    trg_torrent_values values;
+    JsonObject *args = get_arguments(response->obj);
+    JsonArray *removed;
+    guint64 *digests = NULL;
+    gint64 rpcv, detailId;
+    guint i, j, n;
+
+    if (!args || !json_object_has_member(args, FIELD_TORRENTS))
+        return;
+
+    rpcv = shadow ? trg_torrents_shadow_get_rpc_version(shadow) : 0;
+    detailId = shadow ? trg_torrents_shadow_get_detail_id(shadow) : -1;
+
+    torrents_reader_init(&reader, args);
+    n = torrents_reader_get_length(&reader);
+
+    records = g_new0(trg_torrent_records, 1);
+    records->response = json_array_ref(reader.torrents);
+    records->torrents =
+        g_array_sized_new(FALSE, FALSE, sizeof(trg_torrent_record), n);
+    g_array_set_size(records->torrents, n);
+
+    if (shadow)
+        digests = g_new(guint64, n * TORRENT_FIELD_COUNT);
+
+    for (i = 0; i < n; i++) {
+        trg_torrent_record *r =
+            &g_array_index(records->torrents, trg_torrent_record, i);
+
+        torrents_reader_get(&reader, i, &values);
+        torrent_record_fill(r, &values);
+
+        if (torrent_record_has(r, TORRENT_FIELD_FILES) || r->id == detailId)
+            r->json = torrents_reader_get_object(&reader, i, &values);
+
+        r->flags = torrent_get_flags(r, rpcv);
+        r->statusString =
+            torrent_get_status_string(rpcv, r->status, r->flags);
+        r->statusIcon = torrent_get_status_icon(rpcv, r->flags);
+
+        /* Outside the shadow's lock, the diff just compares them. */
+        for (j = 0; digests && j < TORRENT_FIELD_COUNT; j++)
+            digests[i * TORRENT_FIELD_COUNT + j] = values.nodes[j] ?
+                json_node_digest(values.nodes[j]) : 0;
+    }
+
+    if ((removed = get_torrents_removed(args))) {
+        n = json_array_get_length(removed);
+        records->removed = g_array_sized_new(FALSE, FALSE, sizeof(gint64),
+                                             n);
+        for (i = 0; i < n; i++) {
+            gint64 id = json_array_get_int_element(removed, i);
+            g_array_append_val(records->removed, id);
+        }
+    }
+
+    if (shadow) {
+        trg_torrents_shadow_diff(shadow, req, records, digests);
+        g_free(digests);
+    }
+
+    json_object_remove_member(args, FIELD_TORRENTS);
+
+    response->parsed = records;
+    response->parsed_free = trg_torrent_records_free;
+}
+
+/* The detail request is the only one that asks for files. */
+
+gboolean torrent_has_detail(JsonObject * t)
+{
+    return t && json_object_has_member(t, FIELD_FILES);
+}
+
+gint64 torrent_get_file_count(JsonObject * t)
+{
+    if (json_object_has_member(t, FIELD_FILE_COUNT))
+        return json_object_get_int_member(t, FIELD_FILE_COUNT);
+    else if (json_object_has_member(t, FIELD_FILES))
+        return json_array_get_length(torrent_get_files(t));
+    else if (json_object_has_member(t, FIELD_PRIORITIES))
+        return json_array_get_length(torrent_get_priorities(t));
+    else
+        return 0;
+}
+
 JsonArray *torrent_get_peers(JsonObject * t)
 {
     g_assert(json_object_get_array_member(t, FIELD_PEERS));
@@ -234,13 +1085,12 @@ gint64 torrent_get_activity_date(JsonObject * t)
     return json_object_get_int_member(t, FIELD_ACTIVITY_DATE);
 }
 
-guint32
-torrent_get_flags(JsonObject * t, gint64 rpcv, gint64 status,
-                  gint64 fileCount, gint64 downRate, gint64 upRate)
+guint32 torrent_get_flags(const trg_torrent_record * r, gint64 rpcv)
 {
+    gint64 status = r->status;
     guint32 flags = 0;
 
-    if (fileCount > 0 && torrent_get_is_finished(t) == TRUE)
+    if (r->fileCount > 0 && r->leftUntilDone <= 0)
         flags |= TORRENT_FLAG_COMPLETE;
     else
         flags |= TORRENT_FLAG_INCOMPLETE;
@@ -266,7 +1116,7 @@ torrent_get_flags(JsonObject * t, gint64 rpcv, gint64 status,
             if (!(flags & TORRENT_FLAG_COMPLETE))
                 flags |= TORRENT_FLAG_DOWNLOADING;
 
-            if (fileCount <= 0)
+            if (r->fileCount <= 0)
                 flags |= TORRENT_FLAG_DOWNLOADING_METADATA;
 
             flags |= TORRENT_FLAG_ACTIVE;
@@ -276,7 +1126,7 @@ torrent_get_flags(JsonObject * t, gint64 rpcv, gint64 status,
             break;
         case TR_STATUS_SEED:
             flags |= TORRENT_FLAG_SEEDING;
-            if (torrent_get_peers_getting_from_us(t))
+            if (r->peersGettingFromUs)
                 flags |= TORRENT_FLAG_ACTIVE;
             break;
         }
@@ -300,36 +1150,40 @@ torrent_get_flags(JsonObject * t, gint64 rpcv, gint64 status,
             break;
         }
 
-        if (downRate > 0 || upRate > 0)
+        if (r->rateDownload > 0 || r->rateUpload > 0)
             flags |= TORRENT_FLAG_ACTIVE;
     }
 
-    if (torrent_get_error(t) > 0)
+    if (r->error > 0)
         flags |= TORRENT_FLAG_ERROR;
 
     return flags;
 }
 
-gchar *torrent_get_status_icon(gint64 rpcv, guint flags)
+/* Interned, so they can be worked out on a worker thread and shared by
+ * every row with the same status. */
+
+const gchar *torrent_get_status_icon(gint64 rpcv G_GNUC_UNUSED,
+                                     guint flags)
 {
     if (flags & TORRENT_FLAG_ERROR)
-        return g_strdup("dialog-warning");
+        return g_intern_static_string("dialog-warning");
     else if (flags & TORRENT_FLAG_DOWNLOADING_METADATA)
-        return g_strdup("edit-find");
+        return g_intern_static_string("edit-find");
     else if (flags & TORRENT_FLAG_DOWNLOADING)
-        return g_strdup("go-down");
+        return g_intern_static_string("go-down");
     else if (flags & TORRENT_FLAG_PAUSED)
-        return g_strdup("media-playback-pause");
+        return g_intern_static_string("media-playback-pause");
     else if (flags & TORRENT_FLAG_SEEDING)
-        return g_strdup("go-up");
+        return g_intern_static_string("go-up");
     else if (flags & TORRENT_FLAG_CHECKING)
-        return g_strdup("view-refresh");
+        return g_intern_static_string("view-refresh");
     else if (flags & TORRENT_FLAG_DOWNLOADING_WAIT)
-        return g_strdup("media-seek-backward");
+        return g_intern_static_string("media-seek-backward");
     else if (flags & TORRENT_FLAG_SEEDING_WAIT)
-        return g_strdup("media-seek-forward");
+        return g_intern_static_string("media-seek-forward");
     else
-        return g_strdup("dialog-question");
+        return g_intern_static_string("dialog-question");
 }
 
 gint64 torrent_get_done_date(JsonObject * t)
@@ -365,73 +1219,48 @@ const gchar *torrent_get_hash(JsonObject * t)
     return json_object_get_string_member(t, FIELD_HASH_STRING);
 }
 
-gchar *torrent_get_status_string(gint64 rpcv, gint64 value, guint flags)
+const gchar *torrent_get_status_string(gint64 rpcv, gint64 value,
+                                       guint flags)
 {
     if (rpcv >= NEW_STATUS_RPC_VERSION) {
         switch (value) {
         case TR_STATUS_DOWNLOAD:
             if (flags & TORRENT_FLAG_DOWNLOADING_METADATA)
-                return g_strdup(_("Metadata Downloading"));
+                return g_intern_string(_("Metadata Downloading"));
             else
-                return g_strdup(_("Downloading"));
+                return g_intern_string(_("Downloading"));
         case TR_STATUS_DOWNLOAD_WAIT:
-            return g_strdup(_("Queued download"));
+            return g_intern_string(_("Queued download"));
         case TR_STATUS_CHECK_WAIT:
-            return g_strdup(_("Waiting To Check"));
+            return g_intern_string(_("Waiting To Check"));
         case TR_STATUS_CHECK:
-            return g_strdup(_("Checking"));
+            return g_intern_string(_("Checking"));
         case TR_STATUS_SEED_WAIT:
-            return g_strdup(_("Queued seed"));
+            return g_intern_string(_("Queued seed"));
         case TR_STATUS_SEED:
-            return g_strdup(_("Seeding"));
+            return g_intern_string(_("Seeding"));
         case TR_STATUS_STOPPED:
-            return g_strdup(_("Paused"));
+            return g_intern_string(_("Paused"));
         }
     } else {
         switch (value) {
         case OLD_STATUS_DOWNLOADING:
             if (flags & TORRENT_FLAG_DOWNLOADING_METADATA)
-                return g_strdup(_("Metadata Downloading"));
+                return g_intern_string(_("Metadata Downloading"));
             else
-                return g_strdup(_("Downloading"));
+                return g_intern_string(_("Downloading"));
         case OLD_STATUS_PAUSED:
-            return g_strdup(_("Paused"));
+            return g_intern_string(_("Paused"));
         case OLD_STATUS_SEEDING:
-            return g_strdup(_("Seeding"));
+            return g_intern_string(_("Seeding"));
         case OLD_STATUS_CHECKING:
-            return g_strdup(_("Checking"));
+            return g_intern_string(_("Checking"));
         case OLD_STATUS_WAITING_TO_CHECK:
-            return g_strdup(_("Waiting To Check"));
+            return g_intern_string(_("Waiting To Check"));
         }
     }
 
-    return g_strdup(_("Unknown"));
-}
-
-gboolean torrent_has_tracker(JsonObject * t, GRegex * rx, gchar * search)
-{
-    GList *trackers;
-    GList *li;
-    gboolean ret = FALSE;
-
-    trackers = json_array_get_elements(torrent_get_tracker_stats(t));
-
-    for (li = trackers; li; li = g_list_next(li)) {
-        JsonObject *tracker = json_node_get_object((JsonNode *) li->data);
-        const gchar *trackerAnnounce = tracker_stats_get_announce(tracker);
-        gchar *trackerAnnounceHost =
-            trg_gregex_get_first(rx, trackerAnnounce);
-        int cmpResult = g_strcmp0(trackerAnnounceHost, search);
-        g_free(trackerAnnounceHost);
-        if (!cmpResult) {
-            ret = TRUE;
-            break;
-        }
-    }
-
-    g_list_free(trackers);
-
-    return ret;
+    return g_intern_string(_("Unknown"));
 }
 
 gint64 torrent_get_left_until_done(JsonObject * t)
@@ -560,10 +1389,16 @@ gchar *torrent_get_full_dir(JsonObject * obj)
 {
     gchar *containing_path, *name, *delim;
     const gchar *location;
-    JsonArray *files = torrent_get_files(obj);
+    JsonArray *files;
     JsonObject *firstFile;
 
     location = json_object_get_string_member(obj, FIELD_DOWNLOAD_DIR);
+
+    /* without the detail fields, the best we can do is the location */
+    if (!json_object_has_member(obj, FIELD_FILES))
+        return g_strdup(location);
+
+    files = torrent_get_files(obj);
     firstFile = json_array_get_object_element(files, 0);
     name = g_strdup(json_object_get_string_member(firstFile, TFILE_NAME));
 
@@ -44,6 +44,236 @@
 #define TORRENT_ADD_FLAG_PAUSED        (1 << 0) /* 0x01 */
 #define TORRENT_ADD_FLAG_DELETE        (1 << 1) /* 0x02 */
 
+/* torrent-get field registry */
+
+enum {
+    TORRENT_FIELD_ID,
+    TORRENT_FIELD_NAME,
+    TORRENT_FIELD_STATUS,
+    TORRENT_FIELD_ERROR,
+    TORRENT_FIELD_ERROR_STRING,
+    TORRENT_FIELD_RATEDOWNLOAD,
+    TORRENT_FIELD_RATEUPLOAD,
+    TORRENT_FIELD_ETA,
+    TORRENT_FIELD_SIZEWHENDONE,
+    TORRENT_FIELD_TOTAL_SIZE,
+    TORRENT_FIELD_PERCENTDONE,
+    TORRENT_FIELD_RECHECK_PROGRESS,
+    TORRENT_FIELD_METADATAPERCENTCOMPLETE,
+    TORRENT_FIELD_HAVEVALID,
+    TORRENT_FIELD_HAVEUNCHECKED,
+    TORRENT_FIELD_UPLOADEDEVER,
+    TORRENT_FIELD_DOWNLOADEDEVER,
+    TORRENT_FIELD_LEFT_UNTIL_DONE,
+    TORRENT_FIELD_ADDED_DATE,
+    TORRENT_FIELD_DONE_DATE,
+    TORRENT_FIELD_ACTIVITY_DATE,
+    TORRENT_FIELD_DOWNLOAD_DIR,
+    TORRENT_FIELD_QUEUE_POSITION,
+    TORRENT_FIELD_BANDWIDTH_PRIORITY,
+    TORRENT_FIELD_SEED_RATIO_MODE,
+    TORRENT_FIELD_SEED_RATIO_LIMIT,
+    TORRENT_FIELD_PEERS_CONNECTED,
+    TORRENT_FIELD_PEERS_SENDING_TO_US,
+    TORRENT_FIELD_PEERS_GETTING_FROM_US,
+    TORRENT_FIELD_WEB_SEEDS_SENDING_TO_US,
+    TORRENT_FIELD_PEERSFROM,
+    TORRENT_FIELD_TRACKER_STATS,
+    TORRENT_FIELD_UPLOAD_LIMIT,
+    TORRENT_FIELD_UPLOAD_LIMITED,
+    TORRENT_FIELD_DOWNLOAD_LIMIT,
+    TORRENT_FIELD_DOWNLOAD_LIMITED,
+    TORRENT_FIELD_FILE_COUNT,
+    TORRENT_FIELD_PRIORITIES,
+    TORRENT_FIELD_FILES,
+    TORRENT_FIELD_WANTED,
+    TORRENT_FIELD_PEERS,
+    TORRENT_FIELD_COMMENT,
+    TORRENT_FIELD_CREATOR,
+    TORRENT_FIELD_DATE_CREATED,
+    TORRENT_FIELD_HASH_STRING,
+    TORRENT_FIELD_MAGNETLINK,
+    TORRENT_FIELD_CORRUPTEVER,
+    TORRENT_FIELD_HONORS_SESSION_LIMITS,
+    TORRENT_FIELD_PEER_LIMIT,
+    TORRENT_FIELD_ISPRIVATE,
+    TORRENT_FIELD_ISFINISHED,
+    TORRENT_FIELD_ANNOUNCE_URL,
+    TORRENT_FIELD_COUNT
+};
+
+/* Which request(s) a field belongs to. The list set is polled for every
+ * torrent, the detail set only for the torrent shown in the notebook. The
+ * legacy list set stands in for fields missing from older daemons. Core
+ * list fields are polled whatever columns are showing, the rest only when
+ * something on screen uses them. */
+#define TORRENT_FIELDS_LIST            (1 << 0)
+#define TORRENT_FIELDS_LIST_LEGACY     (1 << 1)
+#define TORRENT_FIELDS_DETAIL          (1 << 2)
+#define TORRENT_FIELDS_CORE            (1 << 3)
+
+#define TORRENT_FIELD_BIT(f)           (G_GUINT64_CONSTANT(1) << (f))
+
+typedef struct {
+    const gchar *name;
+    guint sets;
+    gint64 minRpcVersion;
+} trg_torrent_field;
+
+const trg_torrent_field *torrent_field_get(guint field);
+guint64 torrent_fields_for_sets(guint sets, gint64 rpcv);
+gboolean torrent_get_use_table(gint64 rpcv);
+
+/* One torrent from a torrent-get response, indexed by TORRENT_FIELD_*.
+ * Fields that weren't in the response are NULL. */
+typedef struct {
+    JsonNode *nodes[TORRENT_FIELD_COUNT];
+} trg_torrent_values;
+
+/* Walks the torrents of a torrent-get response in either format. For the
+ * table format, columns maps each field to its index in a row (or -1). */
+typedef struct {
+    JsonArray *torrents;
+    JsonArray *header;
+    gint columns[TORRENT_FIELD_COUNT];
+} trg_torrents_reader;
+
+void torrents_reader_init(trg_torrents_reader * reader, JsonObject * args);
+guint torrents_reader_get_length(trg_torrents_reader * reader);
+void torrents_reader_get(trg_torrents_reader * reader, guint i,
+                         trg_torrent_values * values);
+JsonObject *torrents_reader_get_object(trg_torrents_reader * reader,
+                                       guint i,
+                                       const trg_torrent_values * values);
+
+#define torrent_values_has(v, f) ((v)->nodes[(f)] != NULL)
+gint64 torrent_values_get_int(const trg_torrent_values * v, guint field);
+gdouble torrent_values_get_double(const trg_torrent_values * v,
+                                  guint field);
+gboolean torrent_values_get_boolean(const trg_torrent_values * v,
+                                    guint field);
+const gchar *torrent_values_get_string(const trg_torrent_values * v,
+                                       guint field);
+JsonArray *torrent_values_get_array(const trg_torrent_values * v,
+                                    guint field);
+JsonObject *torrent_values_get_object(const trg_torrent_values * v,
+                                      guint field);
+gint64 torrent_values_get_file_count(const trg_torrent_values * v);
+
+/* A torrent from a torrent-get response, worked out on the thread that
+ * received it so the model only has to copy it into a row. Fields holds
+ * the TORRENT_FIELD_BIT()s that were in the response, anything else is
+ * zero. Json is the torrent as an object, only made for a detail response
+ * or the torrent the model keeps the detail of, NULL otherwise. Strings
+ * point into the response, which the records hold, or are interned.
+ * TrackerHosts is the distinct announce hosts, interned, NULL terminated
+ * and owned by the record. NULL if trackerStats wasn't in the response.
+ * Changed is the fields that differ from what the model was last given
+ * for this torrent (all of them without one), with digests of the fields
+ * for the shadow to commit, NULL if nothing changed. Version is the serial
+ * of the response, so a record older than the one a row was filled from
+ * can be told apart, zero without a shadow. The flags, status string and
+ * icon are worked out for the shadow's RPC version, and the strings are
+ * interned. */
+typedef struct {
+    JsonObject *json;
+    guint64 fields;
+    guint64 changed;
+    guint64 *digests;
+    guint version;
+    gint64 id;
+    gint64 status;
+    gint64 error;
+    gint64 rateDownload;
+    gint64 rateUpload;
+    gint64 eta;
+    gint64 sizeWhenDone;
+    gint64 totalSize;
+    gint64 haveValid;
+    gint64 haveUnchecked;
+    gint64 uploadedEver;
+    gint64 downloadedEver;
+    gint64 leftUntilDone;
+    gint64 addedDate;
+    gint64 doneDate;
+    gint64 activityDate;
+    gint64 queuePosition;
+    gint64 bandwidthPriority;
+    gint64 seedRatioMode;
+    gint64 peersConnected;
+    gint64 peersSendingToUs;
+    gint64 peersGettingFromUs;
+    gint64 webseedsSendingToUs;
+    gint64 fileCount;
+    gint64 uploadLimit;
+    gint64 downloadLimit;
+    gint64 seeders;
+    gint64 leechers;
+    gint64 downloads;
+    gint64 fromPex;
+    gint64 fromDht;
+    gint64 fromTrackers;
+    gint64 fromLtep;
+    gint64 fromResume;
+    gint64 fromIncoming;
+    gint64 fromLpd;
+    gdouble percentDone;
+    gdouble recheckProgress;
+    gdouble metadataPercentComplete;
+    gdouble seedRatioLimit;
+    gboolean uploadLimited;
+    gboolean downloadLimited;
+    const gchar *name;
+    const gchar *errorString;
+    const gchar *hashString;
+    const gchar *downloadDir;
+    const gchar *trackerHost;
+    const gchar **trackerHosts;
+    guint32 flags;
+    const gchar *statusString;
+    const gchar *statusIcon;
+} trg_torrent_record;
+
+#define torrent_record_has(r, f) (((r)->fields & TORRENT_FIELD_BIT(f)) != 0)
+
+/* Everything the model needs from a torrent-get response. Response is
+ * its torrents array, held for the strings the records point into.
+ * Applied is set by the model, so records shared by several callbacks go
+ * in once. */
+typedef struct {
+    JsonArray *response;
+    GArray *torrents;
+    GArray *removed;
+    gint connid;
+    guint serial;
+    gboolean applied;
+} trg_torrent_records;
+
+/* What the model has been given from the torrent-get responses for a
+ * connection, so the worker threads can tell it which torrents it doesn't
+ * need to touch and which have gone. Locked, pass it as the parse_data
+ * for torrents_response_parse(), and commit the records as they're
+ * applied. */
+typedef struct _trg_torrents_shadow trg_torrents_shadow;
+
+trg_torrents_shadow *trg_torrents_shadow_new(void);
+void trg_torrents_shadow_free(trg_torrents_shadow * shadow);
+void trg_torrents_shadow_set_rpc_version(trg_torrents_shadow * shadow,
+                                         gint64 rpcv);
+void trg_torrents_shadow_set_detail_id(trg_torrents_shadow * shadow,
+                                       gint64 id);
+
+gboolean trg_torrents_shadow_commit(trg_torrents_shadow * shadow,
+                                    trg_torrent_records * records);
+
+void torrents_response_parse(trg_request * req, trg_response * response);
+void trg_torrent_records_free(gpointer data);
+trg_torrent_records *trg_torrent_records_subset(trg_torrent_records *
+                                                records, JsonArray * ids);
+
+gboolean torrent_has_detail(JsonObject * t);
+gint64 torrent_get_file_count(JsonObject * t);
+
 gint64 torrent_get_total_size(JsonObject * t);
 gint64 torrent_get_size_when_done(JsonObject * t);
 const gchar *torrent_get_name(JsonObject * t);
@@ -63,11 +293,10 @@ gint64 torrent_get_status(JsonObject * t);
 const gchar *torrent_get_creator(JsonObject * t);
 gint64 torrent_get_date_created(JsonObject * t);
 const gchar *torrent_get_hash(JsonObject * t);
-gchar *torrent_get_status_string(gint64 rpcv, gint64 value, guint flags);
-gchar *torrent_get_status_icon(gint64 rpcv, guint flags);
-guint32 torrent_get_flags(JsonObject * t, gint64 rpcv, gint64 status,
-                          gint64 fileCount, gint64 downRate,
-                          gint64 upRate);
+const gchar *torrent_get_status_string(gint64 rpcv, gint64 value,
+                                       guint flags);
+const gchar *torrent_get_status_icon(gint64 rpcv, guint flags);
+guint32 torrent_get_flags(const trg_torrent_record * r, gint64 rpcv);
 JsonArray *torrent_get_peers(JsonObject * t);
 JsonObject *torrent_get_peersfrom(JsonObject * t);
 JsonArray *torrent_get_tracker_stats(JsonObject * t);
@@ -96,7 +325,6 @@ gboolean torrent_get_download_limited(JsonObject * t);
 gdouble torrent_get_seed_ratio_limit(JsonObject * t);
 gint64 torrent_get_seed_ratio_mode(JsonObject * t);
 gint64 torrent_get_peer_limit(JsonObject * t);
-gboolean torrent_has_tracker(JsonObject * t, GRegex * rx, gchar * search);
 gint64 torrent_get_queue_position(JsonObject * args);
 gint64 torrent_get_activity_date(JsonObject * t);
 gchar *torrent_get_full_dir(JsonObject * obj);
@@ -40,6 +40,7 @@
 #include "protocol-constants.h"
 #include "util.h"
 #include "requests.h"
+#include "torrent.h"
 #include "trg-client.h"
 
 /* This class manages/does quite a few things, and is passed around a lot. It:
@@ -84,14 +85,23 @@ struct _TrgClientPrivate {
     TrgPrefs *prefs;
     GPrivate tlsKey;
     gint configSerial;
-    guint http_class;
     GMutex configMutex;
+    CURLM *multi;
+    GThread *ioThread;
+    gint ioQuit;
+    GMutex queueMutex;
+    GQueue queue[TRG_REQUEST_PRIORITIES];
+    GQueue idleTransfers;
+    GQueue running;
+    guint queueSeq;
     gboolean seedRatioLimited;
     gdouble seedRatioLimit;
 };
 
 static void dispatch_async_threadfunc(trg_request * reqrsp,
                                       TrgClient * tc);
+static gpointer trg_client_io_thread(gpointer data);
+static void trg_client_io_stop(TrgClient * tc);
 
 static void
 trg_client_get_property(GObject * object, guint property_id,
@@ -120,6 +130,13 @@ static void trg_client_dispose(GObject * object)
     G_OBJECT_CLASS(trg_client_parent_class)->dispose(object);
 }
 
+static void trg_client_finalize(GObject * object)
+{
+    trg_client_io_stop(TRG_CLIENT(object));
+
+    G_OBJECT_CLASS(trg_client_parent_class)->finalize(object);
+}
+
 static void trg_client_class_init(TrgClientClass * klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS(klass);
@@ -129,6 +146,7 @@ static void trg_client_class_init(TrgClientClass * klass)
     object_class->get_property = trg_client_get_property;
     object_class->set_property = trg_client_set_property;
     object_class->dispose = trg_client_dispose;
+    object_class->finalize = trg_client_finalize;
 
     signals[TC_SESSION_UPDATED] = g_signal_new("session-updated",
                                                G_TYPE_FROM_CLASS
@@ -167,6 +185,14 @@ TrgClient *trg_client_new(void)
     priv->pool = g_thread_pool_new((GFunc) dispatch_async_threadfunc, tc,
                                    DISPATCH_POOL_SIZE, TRUE, NULL);
 
+    g_mutex_init(&priv->queueMutex);
+    priv->multi = curl_multi_init();
+    curl_multi_setopt(priv->multi, CURLMOPT_PIPELINING,
+                      (long) CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(priv->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      (long) TRG_MAX_CONNECTIONS);
+    priv->ioThread = g_thread_new("trg-io", trg_client_io_thread, tc);
+
     tr_formatter_size_init(disk_K, _(disk_K_str), _(disk_M_str),
                            _(disk_G_str), _(disk_T_str));
     tr_formatter_speed_init(speed_K, _(speed_K_str), _(speed_M_str),
@@ -442,12 +468,35 @@ void trg_client_configunlock(TrgClient * tc)
 
 /* formerly http.c */
 
+/* The parsed result of a response that went to several callbacks. */
+
+typedef struct {
+    gint refs;
+    gpointer parsed;
+    GDestroyNotify parsed_free;
+} trg_response_share;
+
+static void trg_response_share_unref(trg_response_share * share)
+{
+    if (g_atomic_int_dec_and_test(&share->refs)) {
+        if (share->parsed && share->parsed_free)
+            share->parsed_free(share->parsed);
+
+        g_free(share);
+    }
+}
+
 void trg_response_free(trg_response * response)
 {
 	if (response) {
 		if (response->obj)
 			json_object_unref(response->obj);
 
+		if (response->shared)
+			trg_response_share_unref(response->shared);
+		else if (response->parsed && response->parsed_free)
+			response->parsed_free(response->parsed);
+
 		if (response->raw)
 			g_free(response->raw);
 
@@ -455,22 +504,49 @@ void trg_response_free(trg_response * response)
 	}
 }
 
+/* Append to the buffer the response is received into, a transfer's (or
+ * for public HTTP, the thread's), which doubles when it has to grow. When
+ * the length is known, it's made big enough for it all at the start.
+ * (A compressed response is bigger than that, but not by so much.)
+ */
+
 static size_t
 http_receive_callback(void *ptr, size_t size, size_t nmemb, void *data)
 {
     size_t realsize = size * nmemb;
-    trg_response *mem = (trg_response *) data;
-
-    mem->raw = g_realloc(mem->raw, mem->size + realsize + 1);
-    if (mem->raw) {
-        memcpy(&(mem->raw[mem->size]), ptr, realsize);
-        mem->size += realsize;
-        mem->raw[mem->size] = 0;
+    trg_tls *tls = (trg_tls *) data;
+    GString *body = tls->body;
+
+    if (body->len == 0) {
+        curl_off_t length = -1;
+
+        if (curl_easy_getinfo(tls->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                              &length) == CURLE_OK
+            && length >= (curl_off_t) body->allocated_len
+            && length < TRG_RESPONSE_BUFFER_MAX) {
+            g_string_set_size(body, (gsize) length);
+            g_string_truncate(body, 0);
+        }
     }
 
+    g_string_append_len(body, ptr, realsize);
+
     return realsize;
 }
 
+/* Done with what's in the buffer. Keep it for the next response, unless
+ * it's grown too big. */
+
+static void trg_tls_body_release(trg_tls * tls)
+{
+    if (tls->body->allocated_len > TRG_RESPONSE_BUFFER_MAX) {
+        g_string_free(tls->body, TRUE);
+        tls->body = g_string_sized_new(TRG_RESPONSE_BUFFER_INITIAL);
+    } else {
+        g_string_truncate(tls->body, 0);
+    }
+}
+
 static size_t
 header_callback(void *ptr, size_t size, size_t nmemb, void *data)
 {
@@ -499,6 +575,7 @@ static trg_tls *trg_tls_new(TrgClient * tc)
 
     tls->curl = curl_easy_init();
     tls->serial = -1;
+    tls->body = g_string_sized_new(TRG_RESPONSE_BUFFER_INITIAL);
 
     return tls;
 }
@@ -518,16 +595,19 @@ static trg_tls *get_tls(TrgClient *tc) {
     return tls;
 }
 
-static CURL* get_curl(TrgClient *tc, guint http_class)
+/* Set up a handle for a request, a worker thread's or a transfer's. It's
+ * only reset when the settings or the kind of request have changed. */
+
+static CURL *trg_client_setup_curl(TrgClient * tc, trg_tls * tls,
+                                   guint http_class)
 {
 	TrgClientPrivate *priv = tc->priv;
 	TrgPrefs *prefs = trg_client_get_prefs(tc);
-	trg_tls *tls = get_tls(tc);
 	CURL *curl = tls->curl;
 
     g_mutex_lock(&priv->configMutex);
 
-    if (priv->configSerial > tls->serial || http_class != priv->http_class) {
+    if (priv->configSerial > tls->serial || http_class != tls->client_class) {
     	gchar *proxy;
 
         curl_easy_reset(curl);
@@ -566,7 +646,7 @@ static CURL* get_curl(TrgClient *tc, guint http_class)
         }
 
         tls->serial = priv->configSerial;
-        priv->http_class = http_class;
+        tls->client_class = http_class;
     }
 
     if (http_class == HTTP_CLASS_TRANSMISSION)
@@ -586,83 +666,344 @@ static CURL* get_curl(TrgClient *tc, guint http_class)
 
 }
 
-static inline int
-trg_http_perform_inner(TrgClient * tc, trg_request * request,
-                       trg_response * response, gboolean recurse)
+static CURL* get_curl(TrgClient *tc, guint http_class)
 {
-    CURL* curl = get_curl(tc, HTTP_CLASS_TRANSMISSION);
-	struct curl_slist *headers = NULL;
-	gchar *session_id = NULL;
-    long httpCode = 0;
+    return trg_client_setup_curl(tc, get_tls(tc), http_class);
+}
 
-    response->size = 0;
-    response->raw = NULL;
+static void trg_request_free(trg_request *req) {
+	g_free(req->body);
+	g_free(req->url);
+	g_free(req->cookie);
 
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->body);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) response);
+	if (req->node)
+		json_node_free(req->node);
+}
 
-	session_id = trg_client_get_session_id(tc);
-	if (session_id)
-		headers = curl_slist_append(NULL, session_id);
+static const gchar *trg_request_get_body(trg_request * req)
+{
+    if (req->node && !req->body)
+        req->body = trg_serialize(req->node);
 
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    return req->body;
+}
 
-    response->status = curl_easy_perform(curl);
+/* Whether a's response answers b as well, because they're the same
+ * request or b asks for some torrents a full torrent-get has. Queue moves
+ * are never the same, doing one twice isn't doing it once. */
 
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+static gboolean trg_request_answers(trg_request * a, trg_request * b)
+{
+    const gchar *method;
 
-    g_free(session_id);
+    if (!a->node || !b->node || a->connid != b->connid
+        || a->parse != b->parse || a->parse_data != b->parse_data)
+        return FALSE;
 
-    if (headers)
-    	curl_slist_free_all(headers);
+    if (torrent_get_covers(a->node, b->node))
+        return TRUE;
 
-    if (response->status == CURLE_OK) {
-        if (httpCode == HTTP_CONFLICT && recurse == TRUE)
-            return trg_http_perform_inner(tc, request, response, FALSE);
-        else if (httpCode != HTTP_OK)
-            response->status = (-httpCode) - 100;
-    }
+    method = request_get_method(a->node);
 
-    return response->status;
+    if (g_strcmp0(method, request_get_method(b->node))
+        || !g_strcmp0(method, METHOD_QUEUE_MOVE_TOP)
+        || !g_strcmp0(method, METHOD_QUEUE_MOVE_UP)
+        || !g_strcmp0(method, METHOD_QUEUE_MOVE_DOWN)
+        || !g_strcmp0(method, METHOD_QUEUE_MOVE_BOTTOM))
+        return FALSE;
+
+    return !g_strcmp0(trg_request_get_body(a), trg_request_get_body(b));
 }
 
-int trg_http_perform(TrgClient * tc, trg_request *request, trg_response * rsp)
+/* Transmission RPC requests don't each take a thread for as long as
+ * they're in flight. One thread runs them all through a curl multi
+ * handle, which keeps connections alive between them and multiplexes
+ * them over one where the server does HTTP/2. Up to TRG_MAX_TRANSFERS go
+ * at once, any more wait, background polls behind everything else.
+ * A finished one is decoded and parsed on the thread pool, which gives
+ * its transfer back when it's done with the body.
+ */
+
+typedef struct {
+    /* A handle and a buffer, set up as a worker thread's are. */
+    trg_tls conn;
+    trg_request *req;
+    trg_response *response;
+    struct curl_slist *headers;
+    gboolean retried;
+    gint64 started;
+} trg_transfer;
+
+static trg_transfer *trg_transfer_new(void)
 {
-    return trg_http_perform_inner(tc, request, rsp, TRUE);
-}
+    trg_transfer *t = g_new0(trg_transfer, 1);
 
-static void trg_request_free(trg_request *req) {
-	g_free(req->body);
-	g_free(req->url);
-	g_free(req->cookie);
+    t->conn.curl = curl_easy_init();
+    t->conn.serial = -1;
+    t->conn.body = g_string_sized_new(TRG_RESPONSE_BUFFER_INITIAL);
 
-	if (req->node)
-		json_node_free(req->node);
+    return t;
 }
 
-/* formerly dispatch.c */
+/* On the I/O thread. */
 
-trg_response *dispatch(TrgClient * tc, trg_request *req)
+static void trg_transfer_start(TrgClient * tc, trg_transfer * t)
 {
-    trg_response *response = g_new0(trg_response, 1);
-    GError *decode_error = NULL;
-    JsonNode *result;
+    TrgClientPrivate *priv = tc->priv;
+    CURL *curl = trg_client_setup_curl(tc, &t->conn,
+                                       HTTP_CLASS_TRANSMISSION);
+    gchar *session_id;
 
-	if (req->node && !req->body)
-		req->body = trg_serialize(req->node);
+    trg_request_get_body(t->req);
 
 #ifdef DEBUG
     if (g_getenv("TRG_SHOW_OUTGOING"))
-        g_message("=>(OUTgoing)=>: %s", req->body);
+        g_message("=>(OUTgoing)=>: %s", t->req->body);
 #endif
 
-    trg_http_perform(tc, req, response);
+    g_string_truncate(t->conn.body, 0);
+
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, t);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, t->req->body);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) &t->conn);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+
+    session_id = trg_client_get_session_id(tc);
+    if (session_id) {
+        t->headers = curl_slist_append(NULL, session_id);
+        g_free(session_id);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, t->headers);
+
+    curl_multi_add_handle(priv->multi, curl);
+    g_queue_push_tail(&priv->running, t);
+}
+
+/* The most urgent waiting request, leaving any that one in flight would
+ * answer, except it went before they were made. They go once it's back,
+ * and anything else like them that comes in before then goes with them.
+ * With the queue locked. */
+
+static trg_request *trg_client_next_request(TrgClientPrivate * priv)
+{
+    GList *li, *ti;
+    gint i;
+
+    for (i = 0; i < TRG_REQUEST_PRIORITIES; i++) {
+        for (li = priv->queue[i].head; li; li = g_list_next(li)) {
+            trg_request *req = (trg_request *) li->data;
+
+            for (ti = priv->running.head; ti; ti = g_list_next(ti))
+                if (trg_request_answers
+                    (((trg_transfer *) ti->data)->req, req))
+                    break;
+
+            if (!ti) {
+                g_queue_delete_link(&priv->queue[i], li);
+                return req;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* Start as many waiting requests as there's room for, the most urgent
+ * first. */
+
+static void trg_client_start_transfers(TrgClient * tc)
+{
+    TrgClientPrivate *priv = tc->priv;
+
+    while (g_queue_get_length(&priv->running) < TRG_MAX_TRANSFERS) {
+        trg_request *req;
+        trg_transfer *t;
+
+        g_mutex_lock(&priv->queueMutex);
+
+        req = trg_client_next_request(priv);
+        t = req ? g_queue_pop_head(&priv->idleTransfers) : NULL;
+
+        g_mutex_unlock(&priv->queueMutex);
+
+        if (!req)
+            break;
+
+        if (!t)
+            t = trg_transfer_new();
+
+        t->req = req;
+        t->response = g_new0(trg_response, 1);
+        t->retried = FALSE;
+        t->started = g_get_monotonic_time();
+        req->transfer = t;
+
+        trg_transfer_start(tc, t);
+    }
+}
+
+/* Hand the finished transfers to the thread pool. A 409 means the session
+ * ID changed, the header callback has the new one, so it goes again. */
+
+static void trg_client_finish_transfers(TrgClient * tc)
+{
+    TrgClientPrivate *priv = tc->priv;
+    CURLMsg *msg;
+    int left;
+
+    while ((msg = curl_multi_info_read(priv->multi, &left))) {
+        trg_transfer *t = NULL;
+        long httpCode = 0;
+
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **) &t);
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE,
+                          &httpCode);
+        t->response->status = msg->data.result;
+
+        curl_multi_remove_handle(priv->multi, msg->easy_handle);
+        g_queue_remove(&priv->running, t);
+
+        if (t->headers) {
+            curl_slist_free_all(t->headers);
+            t->headers = NULL;
+        }
+
+        if (t->response->status == CURLE_OK) {
+            if (httpCode == HTTP_CONFLICT && !t->retried) {
+                t->retried = TRUE;
+                trg_transfer_start(tc, t);
+                continue;
+            } else if (httpCode != HTTP_OK) {
+                t->response->status = (-httpCode) - 100;
+            }
+        }
+
+        t->response->roundTrip = g_get_monotonic_time() - t->started;
+        t->response->raw = t->conn.body->str;
+        t->response->size = t->conn.body->len;
+
+        trg_client_thread_pool_push(tc, t->req, NULL);
+    }
+}
+
+static gpointer trg_client_io_thread(gpointer data)
+{
+    TrgClient *tc = TRG_CLIENT(data);
+    TrgClientPrivate *priv = tc->priv;
+    int running;
+
+    while (!g_atomic_int_get(&priv->ioQuit)) {
+        trg_client_start_transfers(tc);
+        curl_multi_perform(priv->multi, &running);
+        trg_client_finish_transfers(tc);
+        curl_multi_poll(priv->multi, NULL, 0, 1000, NULL);
+    }
+
+    return NULL;
+}
+
+static void trg_transfer_free(TrgClientPrivate * priv, trg_transfer * t)
+{
+    curl_multi_remove_handle(priv->multi, t->conn.curl);
+    curl_easy_cleanup(t->conn.curl);
+    g_string_free(t->conn.body, TRUE);
+
+    if (t->headers)
+        curl_slist_free_all(t->headers);
+
+    g_free(t->response);
+    g_free(t);
+}
+
+/* A request that will never go, and everything waiting on it. */
+
+static void trg_request_discard(trg_request * req)
+{
+    GSList *li;
+
+    for (li = req->followers; li; li = g_slist_next(li)) {
+        trg_request_free((trg_request *) li->data);
+        g_free(li->data);
+    }
+
+    g_slist_free(req->followers);
+    trg_request_free(req);
+    g_free(req);
+}
+
+/* Stop the I/O thread, let the thread pool finish what it has (the
+ * responses are dropped, as if from a previous connection), then free
+ * everything in flight or waiting. */
+
+static void trg_client_io_stop(TrgClient * tc)
+{
+    TrgClientPrivate *priv = tc->priv;
+    trg_transfer *t;
+    trg_request *req;
+    gint i;
+
+    if (!priv->ioThread)
+        return;
+
+    g_atomic_int_set(&priv->ioQuit, TRUE);
+    curl_multi_wakeup(priv->multi);
+    g_thread_join(priv->ioThread);
+    priv->ioThread = NULL;
+
+    g_atomic_int_inc(&priv->connid);
+    g_thread_pool_free(priv->pool, FALSE, TRUE);
+    priv->pool = NULL;
+
+    while ((t = g_queue_pop_head(&priv->running))) {
+        trg_request_discard(t->req);
+        trg_transfer_free(priv, t);
+    }
+
+    while ((t = g_queue_pop_head(&priv->idleTransfers)))
+        trg_transfer_free(priv, t);
+
+    for (i = 0; i < TRG_REQUEST_PRIORITIES; i++)
+        while ((req = g_queue_pop_head(&priv->queue[i])))
+            trg_request_discard(req);
+
+    curl_multi_cleanup(priv->multi);
+    priv->multi = NULL;
+    g_mutex_clear(&priv->queueMutex);
+}
+
+/* On the thread pool, with a finished transfer. Decode the body and parse
+ * it, then give the transfer back for another request. */
+
+static trg_response *dispatch(TrgClient * tc, trg_request *req)
+{
+    TrgClientPrivate *priv = tc->priv;
+    trg_transfer *t = (trg_transfer *) req->transfer;
+    trg_response *response = t->response;
+    gint64 started = g_get_monotonic_time();
+    GError *decode_error = NULL;
+    JsonNode *result;
 
     if (response->status == CURLE_OK)
         response->obj = trg_deserialize(response, &decode_error);
 
-    g_free(response->raw);
+    /* The body was received into the transfer's buffer, which the next
+     * request it's used for will be too. */
     response->raw = NULL;
+    response->size = 0;
+    trg_tls_body_release(&t->conn);
+
+    t->req = NULL;
+    t->response = NULL;
+    req->transfer = NULL;
+
+    g_mutex_lock(&priv->queueMutex);
+    g_queue_push_tail(&priv->idleTransfers, t);
+    g_mutex_unlock(&priv->queueMutex);
+    curl_multi_wakeup(priv->multi);
 
     if (response->status != CURLE_OK)
         return response;
@@ -677,6 +1018,10 @@ trg_response *dispatch(TrgClient * tc, trg_request *req)
     result = json_object_get_member(response->obj, FIELD_RESULT);
     if (!result || g_strcmp0(json_node_get_string(result), FIELD_SUCCESS))
         response->status = FAIL_RESPONSE_UNSUCCESSFUL;
+    else if (req->parse)
+        req->parse(req, response);
+
+    response->parseTime = g_get_monotonic_time() - started;
 
     return response;
 }
@@ -684,15 +1029,15 @@ trg_response *dispatch(TrgClient * tc, trg_request *req)
 trg_response *dispatch_public_http(TrgClient *tc, trg_request *req) {
 	trg_response *response = g_new0(trg_response, 1);
     CURL* curl = get_curl(tc, HTTP_CLASS_PUBLIC);
+    trg_tls *tls = get_tls(tc);
     struct curl_slist *headers = NULL;
     long httpCode = 0;
     gchar *cookie_header = NULL;
 
-    response->size = 0;
-    response->raw = NULL;
+    g_string_truncate(tls->body, 0);
 
 	curl_easy_setopt(curl, CURLOPT_URL, req->url);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) response);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *) tls);
 
 	if (req->cookie) {
 		cookie_header = g_strdup_printf("Cookie: %s", req->cookie);
@@ -704,6 +1049,15 @@ trg_response *dispatch_public_http(TrgClient *tc, trg_request *req) {
 
     response->status = curl_easy_perform(curl);
 
+    /* The callback gets this one, so it needs a copy of its own. */
+    if (tls->body->len > 0) {
+        response->raw = g_malloc(tls->body->len + 1);
+        memcpy(response->raw, tls->body->str, tls->body->len + 1);
+        response->size = tls->body->len;
+    }
+
+    trg_tls_body_release(tls);
+
     trg_request_free(req);
 
     g_free(cookie_header);
@@ -722,26 +1076,300 @@ trg_response *dispatch_public_http(TrgClient *tc, trg_request *req) {
 	return response;
 }
 
-static void dispatch_async_threadfunc(trg_request * req, TrgClient * tc)
+/* The response to a full torrent-get, as a request by id for some of
+ * them would have got it: with its own tag, and only its torrents. */
+
+static void trg_response_narrow(trg_request * follower, trg_response * rsp,
+                                trg_response * copy)
+{
+    JsonObject *reqObj = json_node_get_object(follower->node);
+    JsonArray *ids =
+        json_object_get_array_member(node_get_arguments(follower->node),
+                                     PARAM_IDS);
+    GList *members, *li;
+
+    if (rsp->obj) {
+        copy->obj = json_object_new();
+        members = json_object_get_members(rsp->obj);
+
+        for (li = members; li; li = g_list_next(li))
+            json_object_set_member(copy->obj, (const gchar *) li->data,
+                                   json_node_copy(json_object_get_member
+                                                  (rsp->obj,
+                                                   (const gchar *)
+                                                   li->data)));
+
+        g_list_free(members);
+
+        if (json_object_has_member(reqObj, PARAM_TAG))
+            json_object_set_int_member(copy->obj, PARAM_TAG,
+                                       json_object_get_int_member(reqObj,
+                                                                  PARAM_TAG));
+        else
+            json_object_remove_member(copy->obj, PARAM_TAG);
+    }
+
+    if (rsp->parsed && follower->parse == torrents_response_parse) {
+        copy->parsed = trg_torrent_records_subset(rsp->parsed, ids);
+        copy->parsed_free = trg_torrent_records_free;
+    }
+}
+
+/* A response of its own for each request that waited on req. Those that
+ * asked for the same share its parsed result, which goes with the last
+ * of them. Those that asked for some of the torrents req did get just
+ * theirs, see trg_response_narrow(). */
+
+static GSList *trg_response_fan_out(trg_request * req, trg_response * rsp)
+{
+    trg_response_share *share = NULL;
+    GSList *copies = NULL;
+    GSList *li;
+
+    if (rsp->parsed) {
+        share = g_new0(trg_response_share, 1);
+        share->refs = 1;
+        share->parsed = rsp->parsed;
+        share->parsed_free = rsp->parsed_free;
+        rsp->shared = share;
+    }
+
+    for (li = req->followers; li; li = g_slist_next(li)) {
+        trg_request *follower = (trg_request *) li->data;
+        trg_response *copy = g_new0(trg_response, 1);
+
+        copy->status = rsp->status;
+        copy->roundTrip = rsp->roundTrip;
+        copy->parseTime = rsp->parseTime;
+
+        if (torrent_get_covers(req->node, follower->node)) {
+            trg_response_narrow(follower, rsp, copy);
+        } else {
+            copy->parsed = rsp->parsed;
+
+            if (rsp->obj)
+                copy->obj = json_object_ref(rsp->obj);
+
+            if (share) {
+                g_atomic_int_inc(&share->refs);
+                copy->shared = share;
+            }
+        }
+
+        copies = g_slist_prepend(copies, copy);
+    }
+
+    return g_slist_reverse(copies);
+}
+
+static void dispatch_async_deliver(TrgClient * tc, trg_request * req,
+                                   trg_response * rsp)
 {
     TrgClientPrivate *priv = tc->priv;
+
+    rsp->cb_data = req->cb_data;
+
+    if (req->callback && (req->always
+                          || req->connid ==
+                          g_atomic_int_get(&priv->connid)))
+        g_idle_add(req->callback, rsp);
+    else
+        trg_response_free(rsp);
+}
+
+static void dispatch_async_threadfunc(trg_request * req, TrgClient * tc)
+{
     trg_response *rsp;
+    GSList *copies = NULL;
+    GSList *li, *ci;
 
     if (req->url)
     	rsp = dispatch_public_http(tc, req);
     else
         rsp = dispatch(tc, req);
 
-    rsp->cb_data = req->cb_data;
+    if (req->followers)
+        copies = trg_response_fan_out(req, rsp);
 
-    if (req->callback && req->connid == g_atomic_int_get(&priv->connid))
-        g_idle_add(req->callback, rsp);
-    else
-        trg_response_free(rsp);
+    dispatch_async_deliver(tc, req, rsp);
+
+    for (li = req->followers, ci = copies; li;
+         li = g_slist_next(li), ci = g_slist_next(ci)) {
+        trg_request *follower = (trg_request *) li->data;
 
+        dispatch_async_deliver(tc, follower, (trg_response *) ci->data);
+        trg_request_free(follower);
+        g_free(follower);
+    }
+
+    g_slist_free(req->followers);
+    g_slist_free(copies);
     g_free(req);
 }
 
+/* Whether other is the very same request as req or one already waiting
+ * on it, to the same callback, so its response would only be handled
+ * twice. */
+
+static gboolean trg_request_is_duplicate(trg_request * req,
+                                         trg_request * other)
+{
+    GSList *li;
+
+    if (req->callback == other->callback && req->cb_data == other->cb_data
+        && !g_strcmp0(trg_request_get_body(req),
+                      trg_request_get_body(other)))
+        return TRUE;
+
+    for (li = req->followers; li; li = g_slist_next(li))
+        if (trg_request_is_duplicate((trg_request *) li->data, other))
+            return TRUE;
+
+    return FALSE;
+}
+
+/* req, and anything waiting on it, waits on leader instead. Every one of
+ * them gets called back, except a duplicate of one already waiting. */
+
+static void trg_request_follow(trg_request * leader, trg_request * req)
+{
+    GSList *followers = g_slist_prepend(req->followers, req);
+    GSList *li;
+
+    req->followers = NULL;
+
+    for (li = followers; li; li = g_slist_next(li)) {
+        trg_request *follower = (trg_request *) li->data;
+
+        if (trg_request_is_duplicate(leader, follower)) {
+            trg_request_free(follower);
+            g_free(follower);
+        } else {
+            leader->followers = g_slist_append(leader->followers, follower);
+        }
+    }
+
+    g_slist_free(followers);
+}
+
+static gboolean trg_request_is_torrent_get(trg_request * req)
+{
+    return !g_strcmp0(request_get_method(req->node), METHOD_TORRENT_GET);
+}
+
+/* The ids a request is for, NULL for all of them (or the session). */
+
+static JsonArray *trg_request_get_ids(trg_request * req)
+{
+    JsonObject *args = node_get_arguments(req->node);
+    JsonNode *ids = args ? json_object_get_member(args, PARAM_IDS) : NULL;
+
+    return ids && JSON_NODE_TYPE(ids) == JSON_NODE_ARRAY ?
+        json_node_get_array(ids) : NULL;
+}
+
+/* Whether the order a and b go in could matter, because one changes
+ * something and they're about some of the same torrents. */
+
+static gboolean trg_request_touches(trg_request * a, trg_request * b)
+{
+    JsonArray *idsA, *idsB;
+    guint i, j;
+
+    if (trg_request_is_torrent_get(a) && trg_request_is_torrent_get(b))
+        return FALSE;
+
+    idsA = trg_request_get_ids(a);
+    idsB = trg_request_get_ids(b);
+
+    if (!idsA || !idsB)
+        return TRUE;
+
+    for (i = 0; i < json_array_get_length(idsA); i++)
+        for (j = 0; j < json_array_get_length(idsB); j++)
+            if (json_array_get_int_element(idsA, i) ==
+                json_array_get_int_element(idsB, j))
+                return TRUE;
+
+    return FALSE;
+}
+
+static gint trg_request_seq_compare(gconstpointer a, gconstpointer b)
+{
+    guint sa = (*(trg_request * const *) a)->seq;
+    guint sb = (*(trg_request * const *) b)->seq;
+
+    return sa < sb ? 1 : sa > sb ? -1 : 0;
+}
+
+/* Clicking through actions quickly, or a poll coming round while another
+ * waits, would otherwise send the daemon the same thing over and over.
+ * A new request that one still waiting answers just waits on that one,
+ * which goes as soon as either would have. Looking back from the latest,
+ * that stops at one the order matters against, so stop, start, stop
+ * still ends stopped. A new torrent-get that answers any waiting takes
+ * them on. Either way, one goes and every callback gets the response.
+ * With the queue locked, TRUE if req is now following.
+ */
+
+static gboolean trg_client_coalesce(TrgClientPrivate * priv,
+                                    trg_request * req)
+{
+    gint priority = req->priority;
+    GPtrArray *pending = g_ptr_array_new();
+    GList *li, *next;
+    guint j;
+    gint i;
+
+    for (i = 0; i < TRG_REQUEST_PRIORITIES; i++)
+        for (li = priv->queue[i].head; li; li = g_list_next(li))
+            g_ptr_array_add(pending, li->data);
+
+    g_ptr_array_sort(pending, trg_request_seq_compare);
+
+    for (j = 0; j < pending->len; j++) {
+        trg_request *p = g_ptr_array_index(pending, j);
+
+        if (trg_request_answers(p, req)) {
+            trg_request_follow(p, req);
+
+            if (priority < p->priority) {
+                g_queue_remove(&priv->queue[p->priority], p);
+                p->priority = priority;
+                g_queue_push_tail(&priv->queue[priority], p);
+            }
+
+            g_ptr_array_free(pending, TRUE);
+            return TRUE;
+        }
+
+        if (trg_request_touches(p, req))
+            break;
+    }
+
+    g_ptr_array_free(pending, TRUE);
+
+    if (!trg_request_is_torrent_get(req))
+        return FALSE;
+
+    for (i = 0; i < TRG_REQUEST_PRIORITIES; i++) {
+        for (li = priv->queue[i].head; li; li = next) {
+            trg_request *pending = (trg_request *) li->data;
+
+            next = g_list_next(li);
+
+            if (!trg_request_answers(req, pending))
+                continue;
+
+            g_queue_delete_link(&priv->queue[i], li);
+            req->priority = MIN(req->priority, pending->priority);
+            trg_request_follow(req, pending);
+        }
+    }
+
+    return FALSE;
+}
+
 static gboolean
 dispatch_async_common(TrgClient * tc,
                       trg_request * trg_req,
@@ -754,6 +1382,24 @@ dispatch_async_common(TrgClient * tc,
     trg_req->cb_data = data;
     trg_req->connid = g_atomic_int_get(&priv->connid);
 
+    if (!trg_req->url) {
+        gboolean following;
+
+        g_mutex_lock(&priv->queueMutex);
+
+        trg_req->seq = ++priv->queueSeq;
+        following = trg_client_coalesce(priv, trg_req);
+        if (!following)
+            g_queue_push_tail(&priv->queue[trg_req->priority], trg_req);
+
+        g_mutex_unlock(&priv->queueMutex);
+
+        if (!following)
+            curl_multi_wakeup(priv->multi);
+
+        return TRUE;
+    }
+
     trg_client_thread_pool_push(tc, trg_req, &error);
     if (error) {
         g_error("thread creation error: %s\n", error->message);
@@ -775,6 +1421,62 @@ dispatch_async(TrgClient * tc, JsonNode * req,
     return dispatch_async_common(tc, trg_req, callback, data);
 }
 
+/* Like dispatch_async(), but parse is run on the response before the
+ * callback gets it, on the worker thread rather than the main loop.
+ * parse_data is for parse, and has to be safe to use from that thread.
+ */
+
+gboolean
+dispatch_async_parsed(TrgClient * tc, JsonNode * req,
+                      trg_response_parse_func parse, gpointer parse_data,
+                      GSourceFunc callback, gpointer data)
+{
+    trg_request *trg_req = g_new0(trg_request, 1);
+    trg_req->node = req;
+    trg_req->parse = parse;
+    trg_req->parse_data = parse_data;
+
+    return dispatch_async_common(tc, trg_req, callback, data);
+}
+
+/* Like dispatch_async_parsed(), for a poll nobody is waiting on. Anything
+ * else that's waiting goes first. parse can be NULL.
+ */
+
+gboolean
+dispatch_async_background(TrgClient * tc, JsonNode * req,
+                          trg_response_parse_func parse,
+                          gpointer parse_data, GSourceFunc callback,
+                          gpointer data)
+{
+    trg_request *trg_req = g_new0(trg_request, 1);
+    trg_req->node = req;
+    trg_req->parse = parse;
+    trg_req->parse_data = parse_data;
+    trg_req->priority = TRG_REQUEST_PRIORITY_BACKGROUND;
+
+    return dispatch_async_common(tc, trg_req, callback, data);
+}
+
+/* Like dispatch_async_parsed(), but the callback gets the response even
+ * if the connection changed in the meantime, for callers whose data only
+ * the callback frees. parse can be NULL.
+ */
+
+gboolean
+dispatch_async_always(TrgClient * tc, JsonNode * req,
+                      trg_response_parse_func parse, gpointer parse_data,
+                      GSourceFunc callback, gpointer data)
+{
+    trg_request *trg_req = g_new0(trg_request, 1);
+    trg_req->node = req;
+    trg_req->parse = parse;
+    trg_req->parse_data = parse_data;
+    trg_req->always = TRUE;
+
+    return dispatch_async_common(tc, trg_req, callback, data);
+}
+
 gboolean async_http_request(TrgClient *tc, gchar *url, const gchar *cookie, GSourceFunc callback, gpointer data) {
 	trg_request *trg_req = g_new0(trg_request, 1);
 	trg_req->url = g_strdup(url);
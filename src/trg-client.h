@@ -51,20 +51,53 @@
 
 #define FAIL_JSON_DECODE -2
 #define FAIL_RESPONSE_UNSUCCESSFUL -3
+/* Threads to decode and parse responses, and for other HTTP requests. */
 #define DISPATCH_POOL_SIZE 3
 
+/* RPC requests in flight at once, and connections they can use. */
+#define TRG_MAX_TRANSFERS 8
+#define TRG_MAX_CONNECTIONS 4
+
+#define TRG_REQUEST_PRIORITY_INTERACTIVE 0
+#define TRG_REQUEST_PRIORITY_BACKGROUND 1
+#define TRG_REQUEST_PRIORITIES 2
+
 #define HTTP_CLASS_TRANSMISSION 0
 #define HTTP_CLASS_PUBLIC 1
 
+/* Each worker thread keeps the buffer it receives responses into, unless
+ * one has made it bigger than the max, then it goes back to the initial
+ * size. */
+#define TRG_RESPONSE_BUFFER_INITIAL (64 * 1024)
+#ifndef TRG_RESPONSE_BUFFER_MAX
+#define TRG_RESPONSE_BUFFER_MAX (16 * 1024 * 1024)
+#endif
+
 typedef struct {
     int status;
     int size;
     char *raw;
     JsonObject *obj;
     gpointer cb_data;
+    gpointer parsed;
+    GDestroyNotify parsed_free;
+    /* Set when one response went to several callbacks. It holds parsed
+     * until the last of them is freed. */
+    gpointer shared;
+    /* Microseconds from being sent (the first time, if the session id had
+     * to be renewed) until received, and decoding and parsing took. */
+    gint64 roundTrip;
+    gint64 parseTime;
 } trg_response;
 
-typedef struct {
+typedef struct _trg_request trg_request;
+
+/* Called on the worker thread with a successful response, to work out
+ * anything the callback needs into response->parsed. */
+typedef void (*trg_response_parse_func) (trg_request * req,
+                                         trg_response * response);
+
+struct _trg_request {
     gint connid;
     JsonNode *node;
     gchar *body;
@@ -72,7 +105,17 @@ typedef struct {
     GSourceFunc callback;
     gpointer cb_data;
     gchar *cookie;
-} trg_request;
+    trg_response_parse_func parse;
+    gpointer parse_data;
+    gint priority;
+    gpointer transfer;
+    /* Requests waiting on this one's response, see trg_client_coalesce(). */
+    GSList *followers;
+    /* Order queued in, the later the higher. */
+    guint seq;
+    /* Called back even from before a reconnect, see dispatch_async_always(). */
+    gboolean always;
+};
 
 typedef struct _TrgClientPrivate TrgClientPrivate;
 
@@ -112,19 +155,31 @@ typedef struct {
     int serial;
     guint client_class;
     CURL *curl;
+    /* Responses are received into this, and parsed straight out of it. */
+    GString *body;
 } trg_tls;
 
 /* stuff that used to be in http.h */
 void trg_response_free(trg_response * response);
-int trg_http_perform(TrgClient * tc, trg_request *request, trg_response * rsp);
 
 /* end http.h*/
 
 /* stuff that used to be in dispatch.c */
-trg_response *dispatch(TrgClient * tc, trg_request *req);
 trg_response *dispatch_public_http(TrgClient *tc, trg_request *req);
 gboolean dispatch_async(TrgClient * client, JsonNode * req,
                         GSourceFunc callback, gpointer data);
+gboolean dispatch_async_parsed(TrgClient * client, JsonNode * req,
+                               trg_response_parse_func parse,
+                               gpointer parse_data,
+                               GSourceFunc callback, gpointer data);
+gboolean dispatch_async_background(TrgClient * client, JsonNode * req,
+                                   trg_response_parse_func parse,
+                                   gpointer parse_data,
+                                   GSourceFunc callback, gpointer data);
+gboolean dispatch_async_always(TrgClient * client, JsonNode * req,
+                               trg_response_parse_func parse,
+                               gpointer parse_data,
+                               GSourceFunc callback, gpointer data);
 gboolean async_http_request(TrgClient *tc, gchar *url, const gchar *cookie, GSourceFunc callback, gpointer data);
 
 /* end dispatch.c*/
@@ -270,30 +270,16 @@ load_directory_model(TrgDestinationCombo *self)
     /* Add all previously used download dirs */
     list = g_hash_table_get_values(trg_client_get_torrent_table(client));
     for (li = list; li; li = g_list_next(li)) {
-        GtkTreeRowReference *rr;
-        GtkTreeModel *model;
-        GtkTreePath *path;
-
-        rr = (GtkTreeRowReference *) li->data;
-        model = gtk_tree_row_reference_get_model(rr);
-        path = gtk_tree_row_reference_get_path(rr);
-
-        if (path) {
-            GtkTreeIter iter;
-
-            if (gtk_tree_model_get_iter(model, &iter, path)) {
-                gchar *dd;
-
-                gtk_tree_model_get(model, &iter,
-                                   TORRENT_COLUMN_DOWNLOADDIR, &dd, -1);
-
-                if (dd && g_strcmp0(dd, defaultDir))
-                    g_slist_str_set_add(&dirs, dd);
-                else
-                    g_free(dd);
-            }
-
-            gtk_tree_path_free(path);
+        trg_torrent_table_entry *entry = (trg_torrent_table_entry *) li->data;
+        const gchar *dd =
+            trg_torrent_model_peek_string(TRG_TORRENT_MODEL(entry->model),
+                                          &entry->iter,
+                                          TORRENT_COLUMN_DOWNLOADDIR);
+
+        if (dd && g_strcmp0(dd, defaultDir)) {
+            gchar *dir = g_strdup(dd);
+            if (!g_slist_str_set_add(&dirs, dir))
+                g_free(dir);
         }
     }
 
@@ -54,8 +54,9 @@
 #include "trg-about-window.h"
 #include "trg-tree-view.h"
 #include "trg-prefs.h"
-#include "trg-sortable-filtered-model.h"
+#include "trg-torrent-sort-model.h"
 #include "trg-torrent-model.h"
+#include "trg-torrent-query.h"
 #include "trg-torrent-tree-view.h"
 #include "trg-peers-model.h"
 #include "trg-peers-tree-view.h"
@@ -140,11 +141,15 @@ static gboolean on_session_get_timer(gpointer data);
 static gboolean on_session_get(gpointer data);
 static gboolean on_torrent_get(gpointer data, int mode);
 static gboolean on_torrent_get_first(gpointer data);
+static gboolean on_torrent_get_page(gpointer data);
 static gboolean on_torrent_get_active(gpointer data);
 static gboolean on_torrent_get_update(gpointer data);
 static gboolean on_torrent_get_interactive(gpointer data);
+static gboolean on_torrent_get_refilter(gpointer data);
+static gboolean on_torrent_get_detail(gpointer data);
 static gboolean trg_session_update_timerfunc(gpointer data);
 static gboolean trg_update_torrents_timerfunc(gpointer data);
+static void trg_main_window_note_interaction(TrgMainWindow * win);
 static void open_about_cb(GtkWidget * w, GtkWindow * parent);
 static gboolean trg_torrent_tree_view_visible_func(GtkTreeModel * model,
                                                    GtkTreeIter * iter,
@@ -234,9 +239,15 @@ typedef struct
 
     TrgTorrentModel *torrentModel;
     TrgTorrentTreeView *torrentTreeView;
-    GtkTreeModel *filteredTorrentModel;
     GtkTreeModel *sortedTorrentModel;
     gint selectedTorrentId;
+    gint notebookTorrentId;
+    guint64 polledFields;
+    GArray *fillIds;
+    guint fillNext;
+    guint64 fillFields;
+    GList *batches;
+    trg_torrent_query *query;
 
     TrgTrackersModel *trackersModel;
     TrgTrackersTreeView *trackersTreeView;
@@ -258,6 +269,9 @@ typedef struct
     gboolean hidden;
     gint width, height;
     guint timerId;
+    gboolean pollInFlight;
+    guint pollInterval;
+    gint64 lastInteraction;
     guint sessionTimerId;
     gboolean min_on_start;
     gboolean queuesEnabled;
@@ -290,6 +304,125 @@ gint trg_mw_get_selected_torrent_id(TrgMainWindow * win)
     return priv->selectedTorrentId;
 }
 
+/* The fields a torrent-get for the list asks for. Besides the core ones,
+ * only those needed for the columns showing, the column sorted by, the
+ * state selector's tracker filters and the filter query.
+ */
+
+static guint64 trg_main_window_list_fields(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    gint64 rpcv = trg_client_get_rpc_version(priv->client);
+    guint64 wanted =
+        trg_torrent_tree_view_get_fields(priv->torrentTreeView) |
+        trg_state_selector_get_fields(priv->stateSelector) |
+        trg_torrent_query_get_fields(priv->query);
+    GtkSortType sortType;
+    gint sortColumn;
+
+    if (gtk_tree_sortable_get_sort_column_id
+        (GTK_TREE_SORTABLE(priv->sortedTorrentModel), &sortColumn,
+         &sortType))
+        wanted |= trg_torrent_model_column_fields(sortColumn);
+
+    return torrent_fields_for_sets(TORRENT_FIELDS_CORE, rpcv) |
+        (torrent_fields_for_sets(TORRENT_FIELDS_LIST, rpcv) & wanted);
+}
+
+/* Build a torrent-get for the list, keeping track of the fields every
+ * torrent in the model was last updated with. An active-only or single
+ * torrent update only narrows that down, a full one resets it.
+ */
+
+static JsonNode *trg_main_window_torrent_get(TrgMainWindow * win,
+                                             gint64 id)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    guint64 fields = trg_main_window_list_fields(win);
+
+    if (id == TORRENT_GET_TAG_MODE_FULL)
+        priv->polledFields = fields;
+    else
+        priv->polledFields &= fields;
+
+    return torrent_get(id, fields,
+                       trg_client_get_rpc_version(priv->client));
+}
+
+/* The first torrent-get after connecting only asks for the core fields,
+ * and those of the column sorted by, so the list can be shown and used
+ * straight away. The rest are filled in a page of torrents at a time.
+ */
+
+static JsonNode *trg_main_window_torrent_get_first(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    gint64 rpcv = trg_client_get_rpc_version(priv->client);
+    guint64 fields = torrent_fields_for_sets(TORRENT_FIELDS_CORE, rpcv);
+    GtkSortType sortType;
+    gint sortColumn;
+
+    if (gtk_tree_sortable_get_sort_column_id
+        (GTK_TREE_SORTABLE(priv->sortedTorrentModel), &sortColumn,
+         &sortType))
+        fields |= trg_torrent_model_column_fields(sortColumn) &
+            torrent_fields_for_sets(TORRENT_FIELDS_LIST, rpcv);
+
+    priv->polledFields = fields;
+
+    return torrent_get(TORRENT_GET_TAG_MODE_FULL, fields, rpcv);
+}
+
+/* Whether something (a column being added, say) now wants a field that
+ * not every torrent has. An active-only update won't get it for the rest.
+ */
+
+static gboolean trg_main_window_fields_missing(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    return (trg_main_window_list_fields(win) & ~priv->polledFields) != 0;
+}
+
+static gboolean trg_main_window_notebook_showing(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    return !priv->hidden && gtk_widget_get_visible(priv->notebook);
+}
+
+/* Files, peers and the rest are only requested for the selected torrent,
+ * and only while the notebook is there to show them.
+ */
+
+static void trg_main_window_request_detail(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgClient *client = priv->client;
+
+    if (trg_client_is_connected(client) && priv->selectedTorrentId >= 0
+        && trg_main_window_notebook_showing(win))
+        dispatch_async_parsed(client,
+                              torrent_get_detail(priv->selectedTorrentId,
+                                                 trg_client_get_rpc_version
+                                                 (client)),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_detail, win);
+}
+
+static void trg_main_window_notebook_clear(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    gtk_tree_store_clear(GTK_TREE_STORE(priv->filesModel));
+    gtk_list_store_clear(GTK_LIST_STORE(priv->trackersModel));
+    gtk_list_store_clear(GTK_LIST_STORE(priv->peersModel));
+    trg_general_panel_clear(priv->genDetails);
+    trg_trackers_model_set_no_selection(TRG_TRACKERS_MODEL
+                                        (priv->trackersModel));
+
+    priv->notebookTorrentId = -1;
+}
+
 static void
 update_selected_torrent_notebook(TrgMainWindow * win, gint mode, gint64 id)
 {
@@ -304,14 +437,26 @@ update_selected_torrent_notebook(TrgMainWindow * win, gint mode, gint64 id)
                             &iter)) {
         trg_toolbar_torrent_actions_sensitive(priv->toolBar, TRUE);
         trg_menu_bar_torrent_actions_sensitive(priv->menuBar, TRUE);
-        trg_general_panel_update(priv->genDetails, t, &iter);
-        trg_trackers_model_update(priv->trackersModel, serial, t, mode);
-        trg_files_model_update(priv->filesModel,
-                               GTK_TREE_VIEW(priv->filesTreeView),
-                               serial, t, mode);
-        trg_peers_model_update(priv->peersModel,
-                               TRG_TREE_VIEW(priv->peersTreeView),
-                               serial, t, mode);
+
+        if (torrent_has_detail(t)) {
+            if (priv->notebookTorrentId != id)
+                mode = TORRENT_GET_MODE_FIRST;
+
+            trg_general_panel_update(priv->genDetails, t, &iter);
+            trg_trackers_model_update(priv->trackersModel, serial, t,
+                                      mode);
+            trg_files_model_update(priv->filesModel,
+                                   GTK_TREE_VIEW(priv->filesTreeView),
+                                   serial, t, mode);
+            trg_peers_model_update(priv->peersModel,
+                                   TRG_TREE_VIEW(priv->peersTreeView),
+                                   serial, t, mode);
+            priv->notebookTorrentId = id;
+        } else if (priv->notebookTorrentId != id) {
+            /* don't leave another torrent's details showing while we
+             * wait for this one's */
+            trg_main_window_notebook_clear(win);
+        }
     } else {
         trg_main_window_torrent_scrub(win);
     }
@@ -415,7 +560,6 @@ destroy_window(TrgMainWindow * win, gpointer data G_GNUC_UNUSED)
                           TRG_TREE_VIEW_PERSIST_LAYOUT);
     trg_tree_view_persist(TRG_TREE_VIEW(priv->torrentTreeView),
                           TRG_TREE_VIEW_PERSIST_SORT |
-                          TRG_TREE_VIEW_SORTABLE_PARENT |
                           (trg_prefs_get_int
                            (prefs, TRG_PREFS_KEY_STYLE,
                             TRG_PREFS_GLOBAL) ==
@@ -433,13 +577,45 @@ destroy_window(TrgMainWindow * win, gpointer data G_GNUC_UNUSED)
 #endif
 }
 
-static void open_props_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
+/* Put a detail response into the torrent model. Returns the ID it was for,
+ * or -1 if it failed or we disconnected in the meantime.
+ */
+
+static gint64
+trg_main_window_apply_detail(TrgMainWindow * win, trg_response * response)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
-    TrgTorrentPropsDialog *dialog;
+    TrgClient *client = priv->client;
 
-    if (priv->selectedTorrentId < 0)
-        return;
+    if (!trg_client_is_connected(client) || response->status != CURLE_OK
+        || !response->parsed
+        || !json_object_has_member(response->obj, PARAM_TAG))
+        return -1;
+
+    trg_torrent_model_update(priv->torrentModel, client, response->parsed,
+                             TORRENT_GET_MODE_INTERACTION);
+
+    return json_object_get_int_member(response->obj, PARAM_TAG);
+}
+
+static gboolean on_torrent_get_detail(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    gint64 id = trg_main_window_apply_detail(win, response);
+
+    if (id >= 0 && id == priv->selectedTorrentId)
+        update_selected_torrent_notebook(win, TORRENT_GET_MODE_UPDATE, id);
+
+    trg_response_free(response);
+    return FALSE;
+}
+
+static void trg_main_window_open_props(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgTorrentPropsDialog *dialog;
 
     dialog = trg_torrent_props_dialog_new(GTK_WINDOW(win),
                                           priv->torrentTreeView,
@@ -449,20 +625,93 @@ static void open_props_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     gtk_widget_show_all(GTK_WIDGET(dialog));
 }
 
-static void copy_magnetlink_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
+static gboolean on_torrent_get_detail_props(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    gint64 id = trg_main_window_apply_detail(win, response);
+
+    if (id >= 0 && id == priv->selectedTorrentId)
+        trg_main_window_open_props(win);
+
+    trg_response_free(response);
+    return FALSE;
+}
+
+static gboolean
+trg_main_window_selected_has_detail(TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     JsonObject *json = NULL;
-    GtkClipboard *clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
+
+    return get_torrent_data(trg_client_get_torrent_table(priv->client),
+                            priv->selectedTorrentId, &json, NULL)
+        && torrent_has_detail(json);
+}
+
+static void open_props_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (priv->selectedTorrentId < 0)
         return;
 
-    if(get_torrent_data(trg_client_get_torrent_table(priv->client),
-                priv->selectedTorrentId, &json, NULL))
+    if (trg_main_window_selected_has_detail(win))
+        trg_main_window_open_props(win);
+    else
+        dispatch_async_parsed(priv->client,
+                              torrent_get_detail(priv->selectedTorrentId,
+                                                 trg_client_get_rpc_version
+                                                 (priv->client)),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_detail_props, win);
+}
+
+static void trg_main_window_copy_magnetlink(TrgMainWindow * win, gint64 id)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    JsonObject *json = NULL;
+    GtkClipboard *clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
+
+    if (get_torrent_data(trg_client_get_torrent_table(priv->client),
+                         id, &json, NULL) && torrent_has_detail(json))
         gtk_clipboard_set_text(clip, torrent_get_magnetlink(json), -1);
 }
 
+static gboolean on_torrent_get_detail_magnetlink(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
+    gint64 id = trg_main_window_apply_detail(win, response);
+
+    if (id >= 0)
+        trg_main_window_copy_magnetlink(win, id);
+
+    trg_response_free(response);
+    return FALSE;
+}
+
+static void copy_magnetlink_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    if (priv->selectedTorrentId < 0)
+        return;
+
+    if (trg_main_window_selected_has_detail(win))
+        trg_main_window_copy_magnetlink(win, priv->selectedTorrentId);
+    else
+        dispatch_async_parsed(priv->client,
+                              torrent_get_detail(priv->selectedTorrentId,
+                                                 trg_client_get_rpc_version
+                                                 (priv->client)),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_detail_magnetlink, win);
+}
+
 static void
 torrent_tv_onRowActivated(GtkTreeView * treeview,
                           GtkTreePath * path G_GNUC_UNUSED,
@@ -492,15 +741,377 @@ static void add_cb(GtkWidget * w G_GNUC_UNUSED, gpointer data)
         trg_torrent_add_dialog(win, priv->client);
 }
 
+/* An action on the selected torrents goes in chunks of at most the
+ * "batch-size" preference, so one on thousands of them doesn't make a
+ * request the daemon, or a proxy in front of it, gives up on. Up to
+ * TRG_BATCH_IN_FLIGHT chunks are out at once. Queue moves go one at a
+ * time, in queue order, so the torrents end up where one request would
+ * have put them. The queue positions are asked for first, the list only
+ * has them when the queue column is there. Afterwards only the torrents
+ * acted on are asked for, and only for the fields an action changes.
+ * Every response comes back, even after a disconnect, which abandons the
+ * batch, so the last one can free it.
+ */
+
+#define TRG_BATCH_IN_FLIGHT 2
+
+#define TRG_BATCH_QUEUE_ASCENDING   (1 << 0)
+#define TRG_BATCH_QUEUE_DESCENDING  (1 << 1)
+#define TRG_BATCH_REMOVE            (1 << 2)
+#define TRG_BATCH_DELETE            (1 << 3)
+
+typedef JsonNode *(*trg_batch_request_func) (JsonArray * ids);
+
+typedef struct {
+    TrgMainWindow *win;
+    trg_batch_request_func request;
+    const gchar *label;
+    guint flags;
+    GArray *items;
+    GArray *ids;
+    guint chunk;
+    guint next;
+    guint chunksDone;
+    guint inFlight;
+    gboolean abandoned;
+    trg_response *failed;
+} trg_batch;
+
+typedef struct {
+    gint64 id;
+    gint64 queuePosition;
+    guint index;
+} trg_batch_item;
+
+static void
+trg_batch_item_foreach(GtkTreeModel * model,
+                       GtkTreePath * path G_GNUC_UNUSED,
+                       GtkTreeIter * iter, gpointer data)
+{
+    GArray *items = (GArray *) data;
+    trg_batch_item item;
+
+    gtk_tree_model_get(model, iter, TORRENT_COLUMN_ID, &item.id, -1);
+    item.queuePosition = -1;
+    item.index = items->len;
+    g_array_append_val(items, item);
+}
+
+static gint trg_batch_item_compare(gconstpointer a, gconstpointer b)
+{
+    const trg_batch_item *x = (const trg_batch_item *) a;
+    const trg_batch_item *y = (const trg_batch_item *) b;
+
+    if (x->queuePosition != y->queuePosition)
+        return x->queuePosition < y->queuePosition ? -1 : 1;
+
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+static void trg_batch_free(trg_batch * batch)
+{
+    TrgMainWindowPrivate *priv =
+        trg_main_window_get_instance_private(batch->win);
+
+    priv->batches = g_list_remove(priv->batches, batch);
+
+    if (batch->items)
+        g_array_free(batch->items, TRUE);
+
+    g_free(batch);
+}
+
+static void trg_batch_show_progress(trg_batch * batch)
+{
+    TrgMainWindowPrivate *priv =
+        trg_main_window_get_instance_private(batch->win);
+    gchar *msg;
+
+    if (batch->ids->len <= batch->chunk)
+        return;
+
+    msg = g_strdup_printf(_("%s: %u of %u torrents"), batch->label,
+                          MIN(batch->chunksDone * batch->chunk,
+                              batch->ids->len), batch->ids->len);
+    trg_status_bar_set_progress(priv->statusBar, msg);
+    g_free(msg);
+}
+
+/* Ask for the core fields of the torrents acted on, in chunks too. What
+ * was removed is in the daemon's list of recently removed torrents, which
+ * the recently-active torrent-get brings back. */
+
+static void trg_batch_refresh(trg_batch * batch)
+{
+    TrgMainWindow *win = batch->win;
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgClient *client = priv->client;
+    gint64 rpcv = trg_client_get_rpc_version(client);
+    guint64 fields;
+    guint i, end;
+
+    if (batch->flags & TRG_BATCH_REMOVE) {
+        dispatch_async_parsed(client,
+                              trg_main_window_torrent_get(win,
+                                                          TORRENT_GET_TAG_MODE_UPDATE),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_interactive, win);
+        return;
+    }
+
+    fields = torrent_fields_for_sets(TORRENT_FIELDS_CORE, rpcv)
+        | (priv->polledFields &
+           TORRENT_FIELD_BIT(TORRENT_FIELD_QUEUE_POSITION));
+
+    for (i = 0; i < batch->ids->len; i = end) {
+        JsonArray *ids;
+
+        end = MIN(i + batch->chunk, batch->ids->len);
+        ids = json_array_sized_new(end - i);
+
+        for (; i < end; i++)
+            json_array_add_int_element(ids,
+                                       g_array_index(batch->ids, gint64,
+                                                     i));
+
+        dispatch_async_parsed(client, torrent_get_ids(ids, fields, rpcv),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_interactive, win);
+    }
+}
+
+static void trg_batch_finish(trg_batch * batch)
+{
+    TrgMainWindow *win = batch->win;
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    if (batch->ids->len > batch->chunk)
+        trg_status_bar_set_progress(priv->statusBar, NULL);
+
+    if (!batch->abandoned) {
+        if (batch->failed)
+            trg_dialog_error_handler(win, batch->failed);
+
+        if ((batch->flags & TRG_BATCH_DELETE) && !batch->failed)
+            trg_client_update_session(priv->client, on_session_get, win);
+
+        trg_batch_refresh(batch);
+    }
+
+    trg_response_free(batch->failed);
+    g_array_free(batch->ids, TRUE);
+    trg_batch_free(batch);
+}
+
+static gboolean on_batch_chunk(gpointer data);
+
+static void trg_batch_send(trg_batch * batch)
+{
+    TrgMainWindowPrivate *priv =
+        trg_main_window_get_instance_private(batch->win);
+    guint limit = (batch->flags & (TRG_BATCH_QUEUE_ASCENDING |
+                                   TRG_BATCH_QUEUE_DESCENDING)) ? 1 :
+        TRG_BATCH_IN_FLIGHT;
+
+    while (batch->inFlight < limit && batch->next < batch->ids->len) {
+        guint end = MIN(batch->next + batch->chunk, batch->ids->len);
+        JsonArray *ids = json_array_sized_new(end - batch->next);
+
+        for (; batch->next < end; batch->next++)
+            json_array_add_int_element(ids,
+                                       g_array_index(batch->ids, gint64,
+                                                     batch->next));
+
+        dispatch_async_always(priv->client, batch->request(ids), NULL,
+                              NULL, on_batch_chunk, batch);
+        batch->inFlight++;
+    }
+}
+
+/* Once a chunk fails, the rest aren't sent. */
+
+static gboolean on_batch_chunk(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    trg_batch *batch = (trg_batch *) response->cb_data;
+
+    batch->inFlight--;
+
+    if (response->status != CURLE_OK || batch->abandoned) {
+        batch->next = batch->ids->len;
+
+        if (!batch->failed && response->status != CURLE_OK) {
+            batch->failed = response;
+            response = NULL;
+        }
+    } else {
+        batch->chunksDone++;
+        trg_batch_show_progress(batch);
+    }
+
+    trg_response_free(response);
+
+    trg_batch_send(batch);
+
+    if (batch->inFlight == 0)
+        trg_batch_finish(batch);
+
+    return FALSE;
+}
+
+static void trg_batch_start(trg_batch * batch)
+{
+    GArray *items = batch->items;
+    guint i;
+
+    batch->ids = g_array_sized_new(FALSE, FALSE, sizeof(gint64),
+                                   items->len);
+
+    for (i = 0; i < items->len; i++) {
+        trg_batch_item *item = &g_array_index(items, trg_batch_item,
+                                              (batch->flags &
+                                               TRG_BATCH_QUEUE_DESCENDING)
+                                              ? items->len - 1 - i : i);
+        g_array_append_val(batch->ids, item->id);
+    }
+
+    g_array_free(items, TRUE);
+    batch->items = NULL;
+
+    trg_batch_show_progress(batch);
+    trg_batch_send(batch);
+}
+
+/* The queue positions of the torrents to move, for the order to send
+ * the chunks in. If they can't be had, nothing is moved. */
+
+static gboolean on_batch_positions(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    trg_batch *batch = (trg_batch *) response->cb_data;
+    trg_torrent_records *records =
+        (trg_torrent_records *) response->parsed;
+    GHashTable *positions;
+    guint i;
+
+    if (batch->abandoned) {
+        trg_batch_free(batch);
+        trg_response_free(response);
+        return FALSE;
+    }
+
+    if (response->status != CURLE_OK || !records) {
+        trg_dialog_error_handler(batch->win, response);
+        trg_batch_free(batch);
+        trg_response_free(response);
+        return FALSE;
+    }
+
+    positions = g_hash_table_new(g_int64_hash, g_int64_equal);
+
+    for (i = 0; i < records->torrents->len; i++) {
+        trg_torrent_record *r =
+            &g_array_index(records->torrents, trg_torrent_record, i);
+        g_hash_table_insert(positions, &r->id, &r->queuePosition);
+    }
+
+    for (i = 0; i < batch->items->len; i++) {
+        trg_batch_item *item =
+            &g_array_index(batch->items, trg_batch_item, i);
+        gint64 *position = g_hash_table_lookup(positions, &item->id);
+
+        if (position)
+            item->queuePosition = *position;
+    }
+
+    g_hash_table_destroy(positions);
+    trg_response_free(response);
+
+    g_array_sort(batch->items, trg_batch_item_compare);
+    trg_batch_start(batch);
+
+    return FALSE;
+}
+
+static void
+trg_main_window_batch(TrgMainWindow * win, trg_batch_request_func request,
+                      const gchar * label, guint flags)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgClient *client = priv->client;
+    GtkTreeSelection *selection =
+        gtk_tree_view_get_selection(GTK_TREE_VIEW(priv->torrentTreeView));
+    GArray *items = g_array_new(FALSE, FALSE, sizeof(trg_batch_item));
+    trg_batch *batch;
+    gint64 rpcv;
+    JsonArray *ids;
+    guint i;
+
+    gtk_tree_selection_selected_foreach(selection, trg_batch_item_foreach,
+                                        items);
+
+    if (items->len == 0) {
+        g_array_free(items, TRUE);
+        return;
+    }
+
+    batch = g_new0(trg_batch, 1);
+    priv->batches = g_list_prepend(priv->batches, batch);
+    batch->win = win;
+    batch->request = request;
+    batch->label = label;
+    batch->flags = flags;
+    batch->items = items;
+    batch->chunk =
+        MAX(1, trg_prefs_get_int(trg_client_get_prefs(client),
+                                 TRG_PREFS_KEY_BATCH_SIZE,
+                                 TRG_PREFS_CONNECTION));
+
+    trg_main_window_note_interaction(win);
+
+    /* One request puts them in order itself. */
+    if (!(flags & (TRG_BATCH_QUEUE_ASCENDING | TRG_BATCH_QUEUE_DESCENDING))
+        || items->len <= batch->chunk) {
+        trg_batch_start(batch);
+        return;
+    }
+
+    rpcv = trg_client_get_rpc_version(client);
+    ids = json_array_sized_new(items->len);
+
+    for (i = 0; i < items->len; i++)
+        json_array_add_int_element(ids,
+                                   g_array_index(items, trg_batch_item,
+                                                 i).id);
+
+    dispatch_async_always(client,
+                          torrent_get_ids(ids,
+                                          torrent_fields_for_sets
+                                          (TORRENT_FIELDS_CORE, rpcv) |
+                                          TORRENT_FIELD_BIT
+                                          (TORRENT_FIELD_QUEUE_POSITION),
+                                          rpcv), torrents_response_parse,
+                          NULL, on_batch_positions, batch);
+}
+
+static JsonNode *torrent_remove_keep_data(JsonArray * ids)
+{
+    return torrent_remove(ids, FALSE);
+}
+
+static JsonNode *torrent_remove_delete_data(JsonArray * ids)
+{
+    return torrent_remove(ids, TRUE);
+}
+
 static void pause_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (trg_client_is_connected(priv->client))
-        dispatch_async(priv->client,
-                       torrent_pause(build_json_id_array
-                                     (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_pause, _("Pausing"), 0);
 }
 
 static void pause_all_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
@@ -576,10 +1187,7 @@ static void resume_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (trg_client_is_connected(priv->client))
-        dispatch_async(priv->client,
-                       torrent_start(build_json_id_array
-                                     (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_start, _("Resuming"), 0);
 }
 
 static void disconnect_cb(GtkWidget * w G_GNUC_UNUSED, gpointer data)
@@ -745,10 +1353,7 @@ static void reannounce_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (trg_client_is_connected(priv->client))
-        dispatch_async(priv->client,
-                       torrent_reannounce(build_json_id_array
-                                          (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_reannounce, _("Reannouncing"), 0);
 }
 
 static void verify_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
@@ -756,10 +1361,7 @@ static void verify_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (is_ready_for_torrent_action(win))
-        dispatch_async(priv->client,
-                       torrent_verify(build_json_id_array
-                                      (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_verify, _("Verifying"), 0);
 }
 
 static void start_now_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
@@ -767,10 +1369,7 @@ static void start_now_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (is_ready_for_torrent_action(win))
-        dispatch_async(priv->client,
-                       torrent_start_now(build_json_id_array
-                                         (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_start_now, _("Starting"), 0);
 }
 
 static void up_queue_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
@@ -778,10 +1377,9 @@ static void up_queue_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (priv->queuesEnabled && is_ready_for_torrent_action(win))
-        dispatch_async(priv->client,
-                       torrent_queue_move_up(build_json_id_array
-                                             (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_queue_move_up,
+                              _("Moving up"),
+                              TRG_BATCH_QUEUE_ASCENDING);
 }
 
 static void top_queue_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
@@ -789,10 +1387,9 @@ static void top_queue_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (priv->queuesEnabled && is_ready_for_torrent_action(win))
-        dispatch_async(priv->client,
-                       torrent_queue_move_top(build_json_id_array
-                                              (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_queue_move_top,
+                              _("Moving to top"),
+                              TRG_BATCH_QUEUE_DESCENDING);
 }
 
 static void
@@ -801,10 +1398,9 @@ bottom_queue_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (priv->queuesEnabled && is_ready_for_torrent_action(win))
-        dispatch_async(priv->client,
-                       torrent_queue_move_bottom(build_json_id_array
-                                                 (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_queue_move_bottom,
+                              _("Moving to bottom"),
+                              TRG_BATCH_QUEUE_ASCENDING);
 }
 
 static void down_queue_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
@@ -812,10 +1408,9 @@ static void down_queue_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
     if (priv->queuesEnabled && is_ready_for_torrent_action(win))
-        dispatch_async(priv->client,
-                       torrent_queue_move_down(build_json_id_array
-                                               (priv->torrentTreeView)),
-                       on_generic_interactive_action_response, win);
+        trg_main_window_batch(win, torrent_queue_move_down,
+                              _("Moving down"),
+                              TRG_BATCH_QUEUE_DESCENDING);
 }
 
 static gint
@@ -843,9 +1438,9 @@ confirm_action_dialog(GtkWindow * gtk_win,
         firstNode = g_list_first(list);
 
         gtk_tree_model_get_iter(GTK_TREE_MODEL
-                                (priv->filteredTorrentModel), &firstIter,
+                                (priv->sortedTorrentModel), &firstIter,
                                 firstNode->data);
-        gtk_tree_model_get(GTK_TREE_MODEL(priv->filteredTorrentModel),
+        gtk_tree_model_get(GTK_TREE_MODEL(priv->sortedTorrentModel),
                            &firstIter, TORRENT_COLUMN_NAME, &name, -1);
         g_list_foreach(list, (GFunc) gtk_tree_path_free, NULL);
         g_list_free(list);
@@ -903,34 +1498,28 @@ static void remove_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     GtkTreeSelection *selection;
-    JsonArray *ids;
 
     if (!is_ready_for_torrent_action(win))
         return;
 
     selection =
         gtk_tree_view_get_selection(GTK_TREE_VIEW(priv->torrentTreeView));
-    ids = build_json_id_array(priv->torrentTreeView);
 
     if (confirm_action_dialog(GTK_WINDOW(win), selection, _
                               ("<big><b>Remove torrent \"%s\"?</b></big>"),
                               _("<big><b>Remove %d torrents?</b></big>"),
                               GTK_STOCK_REMOVE) == GTK_RESPONSE_ACCEPT)
-        dispatch_async(priv->client, torrent_remove(ids, FALSE),
-                       on_generic_interactive_action_response, win);
-    else
-        json_array_unref(ids);
+        trg_main_window_batch(win, torrent_remove_keep_data,
+                              _("Removing"), TRG_BATCH_REMOVE);
 }
 
 static void delete_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     GtkTreeSelection *selection;
-    JsonArray *ids;
 
     selection =
         gtk_tree_view_get_selection(GTK_TREE_VIEW(priv->torrentTreeView));
-    ids = build_json_id_array(priv->torrentTreeView);
 
     if (!is_ready_for_torrent_action(win))
         return;
@@ -940,10 +1529,9 @@ static void delete_cb(GtkWidget * w G_GNUC_UNUSED, TrgMainWindow * win)
                               _
                               ("<big><b>Remove and delete %d torrents?</b></big>"),
                               GTK_STOCK_DELETE) == GTK_RESPONSE_ACCEPT)
-        dispatch_async(priv->client, torrent_remove(ids, TRUE),
-                       on_delete_complete, win);
-    else
-        json_array_unref(ids);
+        trg_main_window_batch(win, torrent_remove_delete_data,
+                              _("Deleting"),
+                              TRG_BATCH_REMOVE | TRG_BATCH_DELETE);
 }
 
 static void view_stats_toggled_cb(GtkWidget * w, gpointer data)
@@ -992,6 +1580,7 @@ view_notebook_toggled_cb(GtkCheckMenuItem * w, TrgMainWindow * win)
 
     trg_widget_set_visible(priv->notebook,
                            gtk_check_menu_item_get_active(w));
+    trg_main_window_request_detail(win);
 }
 
 #if TRG_WITH_GRAPH
@@ -1017,6 +1606,7 @@ trg_main_window_notebook_set_visible(TrgMainWindow * win, gboolean visible)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     trg_widget_set_visible(priv->notebook, visible);
+    trg_main_window_request_detail(win);
 }
 
 static GtkWidget *trg_main_window_notebook_new(TrgMainWindow * win)
@@ -1194,8 +1784,15 @@ TRANSMISSION_MIN_SUPPORTED, version);
         trg_main_window_conn_changed(win, TRUE);
         trg_trackers_tree_view_new_connection(priv->trackersTreeView,
                                               client);
-        dispatch_async(client, torrent_get(TORRENT_GET_TAG_MODE_FULL),
-                       on_torrent_get_first, win);
+        trg_torrents_shadow_set_rpc_version(trg_torrent_model_get_shadow
+                                            (priv->torrentModel),
+                                            trg_client_get_rpc_version
+                                            (client));
+        dispatch_async_parsed(client,
+                              trg_main_window_torrent_get_first(win),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_first, win);
     }
 
     trg_response_free(response);
@@ -1271,11 +1868,128 @@ update_whatever_statusicon(TrgMainWindow * win,
     }
 }
 
+/* Milliseconds between torrent-gets as set, longer while the window is
+ * hidden. trg_main_window_adapt_poll() goes from there. */
+
+static guint trg_main_window_poll_base(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgPrefs *prefs = trg_client_get_prefs(priv->client);
+    gint64 interval =
+        gtk_widget_get_visible(GTK_WIDGET(win)) ? trg_prefs_get_int(prefs,
+                                                                    TRG_PREFS_KEY_UPDATE_INTERVAL,
+                                                                    TRG_PREFS_CONNECTION)
+        : trg_prefs_get_int(prefs, TRG_PREFS_KEY_MINUPDATE_INTERVAL,
+                            TRG_PREFS_CONNECTION);
+
+    return (interval < 1 ? TRG_INTERVAL_DEFAULT : (guint) interval) * 1000;
+}
+
+/* Only one poll is ever out. The next is scheduled when it's back. */
+
+static void trg_main_window_schedule_poll(TrgMainWindow * win,
+                                          guint interval)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    if (priv->pollInFlight)
+        return;
+
+    if (priv->timerId > 0)
+        g_source_remove(priv->timerId);
+
+    priv->pollInterval = interval;
+    priv->timerId =
+        g_timeout_add(interval, trg_update_torrents_timerfunc, win);
+}
+
+/* The interval as set is where polling starts. While the user's doing
+ * something, or many torrents are transferring, it polls up to twice as
+ * often. With nothing transferring it backs off, by half again each
+ * time, to four times as long. Whichever, the interval is never less
+ * than twice what the last poll cost, from sending it to having it in
+ * the model, so a slow daemon (or client) isn't kept busy.
+ */
+
+#define TRG_POLL_MIN_MS             1000
+#define TRG_POLL_BUSY_ACTIVE        10
+#define TRG_POLL_INTERACTION_US     (10 * G_USEC_PER_SEC)
+
+static guint trg_main_window_poll_fast(TrgMainWindow * win)
+{
+    return MAX(trg_main_window_poll_base(win) / 2, TRG_POLL_MIN_MS);
+}
+
+static void
+trg_main_window_adapt_poll(TrgMainWindow * win, trg_response * response,
+                           trg_torrent_model_update_stats * stats,
+                           gint64 applyTime)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    guint base = trg_main_window_poll_base(win);
+    guint cost = (guint) ((response->roundTrip + response->parseTime +
+                           applyTime) / 1000);
+    const gchar *reason;
+    guint interval;
+    gchar *msg;
+
+    if (g_get_monotonic_time() - priv->lastInteraction <
+        TRG_POLL_INTERACTION_US) {
+        interval = trg_main_window_poll_fast(win);
+        reason = _("interacting");
+    } else if (stats->active >= TRG_POLL_BUSY_ACTIVE) {
+        interval = trg_main_window_poll_fast(win);
+        reason = _("busy");
+    } else if (stats->active > 0) {
+        interval = base;
+        reason = _("active");
+    } else {
+        interval = MIN(MAX(priv->pollInterval, base) * 3 / 2, base * 4);
+        reason = _("idle");
+    }
+
+    if (interval < cost * 2) {
+        interval = cost * 2;
+        reason = _("slow");
+    }
+
+    interval = MAX(interval, TRG_POLL_MIN_MS);
+
+    msg = g_strdup_printf(_("Polling every %.1fs (%s): round trip %dms, "
+                            "parse %dms, apply %dms"), interval / 1000.0,
+                          reason, (gint) (response->roundTrip / 1000),
+                          (gint) (response->parseTime / 1000),
+                          (gint) (applyTime / 1000));
+    trg_status_bar_set_poll_info(priv->statusBar, msg);
+    g_free(msg);
+
+    trg_main_window_schedule_poll(win, interval);
+}
+
+/* Poll sooner for a while, to show what came of it. */
+
+static void trg_main_window_note_interaction(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    guint fast = trg_main_window_poll_fast(win);
+
+    priv->lastInteraction = g_get_monotonic_time();
+
+    if (priv->timerId > 0 && priv->pollInterval > fast)
+        trg_main_window_schedule_poll(win, fast);
+}
+
 /*
  * The callback for a torrent-get response.
  */
 
-static gboolean on_torrent_get(gpointer data, int mode)
+/* Apply a torrent-get response to the list. withDetail asks for the
+ * selected torrent's detail afterwards, which a fill page leaves to the
+ * end of the fill. */
+
+static gboolean
+trg_main_window_torrent_get_apply(gpointer data, int mode,
+                                  gboolean withDetail)
 {
     trg_response *response = (trg_response *) data;
     TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
@@ -1283,9 +1997,11 @@ static gboolean on_torrent_get(gpointer data, int mode)
     TrgClient *client = priv->client;
     TrgPrefs *prefs = trg_client_get_prefs(client);
     trg_torrent_model_update_stats *stats;
-    guint interval;
-    gint old_sort_id;
-    GtkSortType old_order;
+    gint64 started = g_get_monotonic_time();
+    gint64 applyTime;
+
+    if (mode == TORRENT_GET_MODE_ACTIVE || mode == TORRENT_GET_MODE_UPDATE)
+        priv->pollInFlight = FALSE;
 
     /* Disconnected between request and response callback */
     if (!trg_client_is_connected(client)) {
@@ -1293,15 +2009,6 @@ static gboolean on_torrent_get(gpointer data, int mode)
         return FALSE;
     }
 
-    interval =
-        gtk_widget_get_visible(GTK_WIDGET(win)) ? trg_prefs_get_int(prefs,
-                                                                    TRG_PREFS_KEY_UPDATE_INTERVAL,
-                                                                    TRG_PREFS_CONNECTION)
-        : trg_prefs_get_int(prefs, TRG_PREFS_KEY_MINUPDATE_INTERVAL,
-                            TRG_PREFS_CONNECTION);
-    if (interval < 1)
-        interval = TRG_INTERVAL_DEFAULT;
-
     if (response->status != CURLE_OK) {
         gint64 max_retries =
             trg_prefs_get_int(prefs, TRG_PREFS_KEY_RETRIES,
@@ -1321,9 +2028,8 @@ static gboolean on_torrent_get(gpointer data, int mode)
                                                statusBarMsg);
             g_free(msg);
             g_free(statusBarMsg);
-            priv->timerId = g_timeout_add_seconds(interval,
-                                                  trg_update_torrents_timerfunc,
-                                                  win);
+            trg_main_window_schedule_poll(win,
+                                          trg_main_window_poll_base(win));
         }
 
         trg_response_free(response);
@@ -1334,29 +2040,43 @@ static gboolean on_torrent_get(gpointer data, int mode)
     trg_client_reset_failcount(client);
     trg_client_inc_serial(client);
 
-    if (mode != TORRENT_GET_MODE_FIRST)
+    /* On the first update every row is new, and the view would be told
+     * about each one as it goes in. Take the model away from it, and give
+     * it back once they're all in and sorted, so it only builds once. */
+    if (mode == TORRENT_GET_MODE_FIRST)
+        gtk_tree_view_set_model(GTK_TREE_VIEW(priv->torrentTreeView),
+                                NULL);
+    else
         gtk_widget_freeze_child_notify(GTK_WIDGET(priv->torrentTreeView));
 
-    gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE
-                                         (priv->sortedTorrentModel),
-                                         &old_sort_id, &old_order);
-    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE
-                                         (priv->sortedTorrentModel),
-                                         GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID,
-                                         GTK_SORT_ASCENDING);
-
+    /* The sorted model puts changed rows back in order when it's done. */
     stats =
-        trg_torrent_model_update(priv->torrentModel, client, response->obj,
-                                 mode);
+        trg_torrent_model_update(priv->torrentModel, client,
+                                 response->parsed, mode);
+
+    /* Rows that didn't change still move in or out of an age term. */
+    if ((mode == TORRENT_GET_MODE_ACTIVE || mode == TORRENT_GET_MODE_UPDATE)
+        && trg_torrent_query_has_age(priv->query))
+        trg_torrent_sort_model_refilter(TRG_TORRENT_SORT_MODEL
+                                        (priv->sortedTorrentModel));
+
+    if (mode == TORRENT_GET_MODE_FIRST)
+        gtk_tree_view_set_model(GTK_TREE_VIEW(priv->torrentTreeView),
+                                priv->sortedTorrentModel);
+    else
+        gtk_widget_thaw_child_notify(GTK_WIDGET(priv->torrentTreeView));
 
-    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE
-                                         (priv->sortedTorrentModel),
-                                         old_sort_id, old_order);
+    applyTime = g_get_monotonic_time() - started;
 
-    if (mode != TORRENT_GET_MODE_FIRST)
-        gtk_widget_thaw_child_notify(GTK_WIDGET(priv->torrentTreeView));
+#ifdef DEBUG
+    if (g_getenv("TRG_SHOW_TIMING"))
+        g_message("torrent-get (mode %d) applied in %" G_GINT64_FORMAT
+                  "us", mode, applyTime);
+#endif
 
     update_selected_torrent_notebook(win, mode, priv->selectedTorrentId);
+    if (withDetail)
+        trg_main_window_request_detail(win);
     trg_status_bar_update(priv->statusBar, stats, client);
     update_whatever_statusicon(win, stats);
 
@@ -1365,27 +2085,149 @@ static gboolean on_torrent_get(gpointer data, int mode)
         trg_torrent_graph_set_speed(priv->graph, stats);
 #endif
 
-    if (mode != TORRENT_GET_MODE_INTERACTION)
-        priv->timerId = g_timeout_add_seconds(interval,
-                                              trg_update_torrents_timerfunc,
-                                              win);
+    /* After the first, polling starts once the rest is filled in. */
+    if (mode == TORRENT_GET_MODE_ACTIVE || mode == TORRENT_GET_MODE_UPDATE)
+        trg_main_window_adapt_poll(win, response, stats, applyTime);
 
     trg_response_free(response);
     return FALSE;
 }
 
+static gboolean on_torrent_get(gpointer data, int mode)
+{
+    return trg_main_window_torrent_get_apply(data, mode, TRUE);
+}
+
 static gboolean on_torrent_get_active(gpointer data)
 {
     return on_torrent_get(data, TORRENT_GET_MODE_ACTIVE);
 }
 
+#define TRG_FILL_PAGE_SIZE 250
+
+/* Ask for the next page of torrents to fill in, or start polling when
+ * they're all done.
+ */
+
+static void trg_main_window_fill_next(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    TrgClient *client = priv->client;
+    JsonArray *ids;
+    guint end;
+
+    if (!trg_client_is_connected(client))
+        return;
+
+    if (priv->fillNext >= priv->fillIds->len) {
+        priv->polledFields = priv->fillFields;
+        g_array_set_size(priv->fillIds, 0);
+        priv->fillNext = 0;
+
+        /* The pages didn't ask for it, so the selection's detail is
+         * asked for once here. */
+        trg_main_window_request_detail(win);
+        trg_main_window_schedule_poll(win, trg_main_window_poll_base(win));
+        return;
+    }
+
+    end = MIN(priv->fillNext + TRG_FILL_PAGE_SIZE, priv->fillIds->len);
+    ids = json_array_sized_new(end - priv->fillNext);
+
+    for (; priv->fillNext < end; priv->fillNext++)
+        json_array_add_int_element(ids,
+                                   g_array_index(priv->fillIds, gint64,
+                                                 priv->fillNext));
+
+    dispatch_async_background(client,
+                              torrent_get_ids(ids, priv->fillFields,
+                                              trg_client_get_rpc_version
+                                              (client)),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_page, win);
+}
+
+/* Fill in the fields the first torrent-get left out. The rows as they're
+ * sorted go first, the view has just been given them so that's from the
+ * top of what's on screen down, then those filtered out.
+ */
+
+static void trg_main_window_fill_start(TrgMainWindow * win)
+{
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    GtkTreeModel *child = GTK_TREE_MODEL(priv->torrentModel);
+    GtkTreeIter iter;
+    gint64 id;
+
+    g_array_set_size(priv->fillIds, 0);
+    priv->fillNext = 0;
+    priv->fillFields = trg_main_window_list_fields(win);
+
+    if (gtk_tree_model_get_iter_first(priv->sortedTorrentModel, &iter)) {
+        do {
+            GtkTreeIter childIter;
+            trg_torrent_sort_model_convert_iter_to_child_iter
+                (TRG_TORRENT_SORT_MODEL(priv->sortedTorrentModel),
+                 &childIter, &iter);
+            id = trg_torrent_model_get_int64(priv->torrentModel,
+                                             &childIter,
+                                             TORRENT_COLUMN_ID);
+            g_array_append_val(priv->fillIds, id);
+        } while (gtk_tree_model_iter_next
+                 (priv->sortedTorrentModel, &iter));
+    }
+
+    if (gtk_tree_model_get_iter_first(child, &iter)) {
+        do {
+            if (trg_torrent_tree_view_visible_func(child, &iter, win))
+                continue;
+            id = trg_torrent_model_get_int64(priv->torrentModel, &iter,
+                                             TORRENT_COLUMN_ID);
+            g_array_append_val(priv->fillIds, id);
+        } while (gtk_tree_model_iter_next(child, &iter));
+    }
+
+    trg_main_window_fill_next(win);
+}
+
+static gboolean on_torrent_get_page(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+
+    /* A failure starts polling again, which asks for everything. */
+    gboolean ok = response->status == CURLE_OK;
+    gboolean result =
+        trg_main_window_torrent_get_apply(data,
+                                          TORRENT_GET_MODE_INTERACTION,
+                                          FALSE);
+
+    if (ok) {
+        trg_main_window_fill_next(win);
+    } else {
+        g_array_set_size(priv->fillIds, 0);
+        priv->fillNext = 0;
+    }
+
+    return result;
+}
+
 static gboolean on_torrent_get_first(gpointer data)
 {
     trg_response *response = (trg_response *) data;
     TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
-    gboolean result = on_torrent_get(data, TORRENT_GET_MODE_FIRST);
+    /* The fill asks for the detail when it's done. */
+    gboolean ok = response->status == CURLE_OK;
+    gboolean result =
+        trg_main_window_torrent_get_apply(data, TORRENT_GET_MODE_FIRST,
+                                          FALSE);
+
+    if (ok)
+        trg_main_window_fill_start(win);
 
     if (priv->args) {
         trg_add_from_filename(win, priv->args);
@@ -1400,6 +2242,22 @@ static gboolean on_torrent_get_interactive(gpointer data)
     return on_torrent_get(data, TORRENT_GET_MODE_INTERACTION);
 }
 
+/* For a filter that needs fields the list wasn't polled with. The rows
+ * it was tested against didn't have them yet, so test them all again. */
+
+static gboolean on_torrent_get_refilter(gpointer data)
+{
+    trg_response *response = (trg_response *) data;
+    TrgMainWindow *win = TRG_MAIN_WINDOW(response->cb_data);
+    TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
+    gboolean result = on_torrent_get(data, TORRENT_GET_MODE_INTERACTION);
+
+    trg_torrent_sort_model_refilter(TRG_TORRENT_SORT_MODEL
+                                    (priv->sortedTorrentModel));
+
+    return result;
+}
+
 static gboolean on_torrent_get_update(gpointer data)
 {
     return on_torrent_get(data, TORRENT_GET_MODE_UPDATE);
@@ -1410,7 +2268,8 @@ static gboolean trg_session_update_timerfunc(gpointer data)
     TrgMainWindow *win = TRG_MAIN_WINDOW(data);
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
-    trg_client_update_session(priv->client, on_session_get_timer, win);
+    dispatch_async_background(priv->client, session_get(), NULL, NULL,
+                              on_session_get_timer, win);
 
     return FALSE;
 }
@@ -1427,7 +2286,9 @@ static gboolean trg_update_torrents_timerfunc(gpointer data)
     TrgClient *tc = priv->client;
     TrgPrefs *prefs = trg_client_get_prefs(tc);
 
-    if (trg_client_is_connected(tc)) {
+    priv->timerId = 0;
+
+    if (trg_client_is_connected(tc) && !priv->pollInFlight) {
         gboolean activeOnly = trg_prefs_get_bool(prefs,
                                                  TRG_PREFS_KEY_UPDATE_ACTIVE_ONLY,
                                                  TRG_PREFS_CONNECTION)
@@ -1438,11 +2299,21 @@ static gboolean trg_update_torrents_timerfunc(gpointer data)
                                                                   TRG_PREFS_ACTIVEONLY_FULLSYNC_EVERY,
                                                                   TRG_PREFS_CONNECTION)
                     != 0));
-        dispatch_async(tc,
-                       torrent_get(activeOnly ? TORRENT_GET_TAG_MODE_UPDATE
-                                   : TORRENT_GET_TAG_MODE_FULL),
-                       activeOnly ? on_torrent_get_active :
-                       on_torrent_get_update, data);
+
+        if (activeOnly && trg_main_window_fields_missing(win))
+            activeOnly = FALSE;
+
+        priv->pollInFlight = TRUE;
+        dispatch_async_background(tc,
+                                  trg_main_window_torrent_get(win,
+                                                              activeOnly ?
+                                                              TORRENT_GET_TAG_MODE_UPDATE
+                                                              :
+                                                              TORRENT_GET_TAG_MODE_FULL),
+                                  torrents_response_parse,
+                                  trg_torrent_model_get_shadow(priv->torrentModel),
+                                  activeOnly ? on_torrent_get_active :
+                                  on_torrent_get_update, data);
     }
 
     return FALSE;
@@ -1462,68 +2333,10 @@ trg_torrent_tree_view_visible_func(GtkTreeModel * model,
 {
     TrgMainWindow *win = TRG_MAIN_WINDOW(data);
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
-    guint flags;
-    gboolean visible;
-    const gchar *filterText;
-
-    guint32 criteria = trg_state_selector_get_flag(priv->stateSelector);
-
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_FLAGS, &flags, -1);
-
-    if (criteria != 0) {
-        if (criteria & FILTER_FLAG_TRACKER) {
-            gchar *text =
-                trg_state_selector_get_selected_text(priv->stateSelector);
-            JsonObject *json = NULL;
-            gboolean matchesTracker;
-            gtk_tree_model_get(model, iter, TORRENT_COLUMN_JSON, &json,
-                               -1);
-            matchesTracker = (!json
-                              || !torrent_has_tracker(json,
-                                                      trg_state_selector_get_url_host_regex
-                                                      (priv->
-                                                       stateSelector),
-                                                      text));
-            g_free(text);
-            if (matchesTracker)
-                return FALSE;
-        } else if (criteria & FILTER_FLAG_DIR) {
-            gchar *text =
-                trg_state_selector_get_selected_text(priv->stateSelector);
-            gchar *dd;
-            int cmp;
-            gtk_tree_model_get(model, iter,
-                               TORRENT_COLUMN_DOWNLOADDIR_SHORT, &dd, -1);
-            cmp = g_strcmp0(text, dd);
-            g_free(dd);
-            g_free(text);
-            if (cmp)
-                return FALSE;
-        } else if (!(flags & criteria)) {
-            return FALSE;
-        }
-    }
+    TrgTorrentModel *torrentModel = TRG_TORRENT_MODEL(model);
 
-    visible = TRUE;
-
-    filterText = gtk_entry_get_text(GTK_ENTRY(priv->filterEntry));
-    if (strlen(filterText) > 0) {
-        gchar *name = NULL;
-        gtk_tree_model_get(model, iter, TORRENT_COLUMN_NAME, &name, -1);
-        if (name) {
-            gchar *filterCmp = g_utf8_casefold(filterText, -1);
-            gchar *nameCmp = g_utf8_casefold(name, -1);
-
-            if (!strstr(nameCmp, filterCmp))
-                visible = FALSE;
-
-            g_free(nameCmp);
-            g_free(filterCmp);
-            g_free(name);
-        }
-    }
-
-    return visible;
+    return trg_torrent_query_matches(priv->query, torrentModel, iter)
+        && trg_torrent_model_name_matches(torrentModel, iter);
 }
 
 void trg_main_window_reload_dir_aliases(TrgMainWindow * win)
@@ -1590,15 +2403,17 @@ torrent_selection_changed(GtkTreeSelection * selection,
         return TRUE;
     }
 
+    trg_main_window_note_interaction(win);
+
     selectionList = gtk_tree_selection_get_selected_rows(selection, NULL);
     firstNode = g_list_first(selectionList);
     id = -1;
 
     if (firstNode) {
         GtkTreeIter iter;
-        if (gtk_tree_model_get_iter(priv->filteredTorrentModel, &iter,
+        if (gtk_tree_model_get_iter(priv->sortedTorrentModel, &iter,
                                     (GtkTreePath *) firstNode->data)) {
-            gtk_tree_model_get(priv->filteredTorrentModel, &iter,
+            gtk_tree_model_get(priv->sortedTorrentModel, &iter,
                                TORRENT_COLUMN_ID, &id, -1);
         }
     }
@@ -1607,6 +2422,7 @@ torrent_selection_changed(GtkTreeSelection * selection,
     g_list_free(selectionList);
 
     update_selected_torrent_notebook(win, TORRENT_GET_MODE_FIRST, id);
+    trg_main_window_request_detail(win);
 
     return TRUE;
 }
@@ -1639,8 +2455,11 @@ void on_generic_interactive_action(TrgMainWindow *win, trg_response *response) {
             else
                 id = TORRENT_GET_TAG_MODE_FULL;
 
-            dispatch_async(tc, torrent_get(id), on_torrent_get_interactive,
-                           win);
+            trg_main_window_note_interaction(win);
+            dispatch_async_parsed(tc, trg_main_window_torrent_get(win, id),
+                                  torrents_response_parse,
+                                  trg_torrent_model_get_shadow(priv->torrentModel),
+                                  on_torrent_get_interactive, win);
         }
     }
 
@@ -1661,12 +2480,7 @@ static void trg_main_window_torrent_scrub(TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
 
-    gtk_tree_store_clear(GTK_TREE_STORE(priv->filesModel));
-    gtk_list_store_clear(GTK_LIST_STORE(priv->trackersModel));
-    gtk_list_store_clear(GTK_LIST_STORE(priv->peersModel));
-    trg_general_panel_clear(priv->genDetails);
-    trg_trackers_model_set_no_selection(TRG_TRACKERS_MODEL
-                                        (priv->trackersModel));
+    trg_main_window_notebook_clear(win);
 
     trg_toolbar_torrent_actions_sensitive(priv->toolBar, FALSE);
     trg_menu_bar_torrent_actions_sensitive(priv->menuBar, FALSE);
@@ -1676,20 +2490,56 @@ static void entry_filter_changed_cb(GtkWidget * w, TrgMainWindow * win)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     gboolean clearSensitive = gtk_entry_get_text_length(GTK_ENTRY(w)) > 0;
-
-    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER
-                                   (priv->filteredTorrentModel));
+    trg_torrent_query *query =
+        trg_torrent_query_compile(gtk_entry_get_text(GTK_ENTRY(w)));
+    gboolean changed;
+
+    trg_torrent_query_set_selector(query,
+                                   trg_state_selector_get_flag
+                                   (priv->stateSelector),
+                                   trg_state_selector_get_selected_name
+                                   (priv->stateSelector));
+
+    /* Both run, the name filter has to be kept up to date. */
+    changed = !trg_torrent_query_equal(query, priv->query);
+    changed |= trg_torrent_model_set_name_filter(priv->torrentModel,
+                                                 trg_torrent_query_get_name_text
+                                                 (query));
+
+    trg_torrent_query_free(priv->query);
+    priv->query = query;
+
+    if (changed)
+        trg_torrent_sort_model_refilter(TRG_TORRENT_SORT_MODEL
+                                        (priv->sortedTorrentModel));
+
+    /* Until every torrent has the fields the query tests, it can't match
+     * on them, so get them now rather than at the next full poll. */
+    if (changed && trg_client_is_connected(priv->client)
+        && trg_main_window_fields_missing(win))
+        dispatch_async_parsed(priv->client,
+                              trg_main_window_torrent_get(win,
+                                                          TORRENT_GET_TAG_MODE_FULL),
+                              torrents_response_parse,
+                              trg_torrent_model_get_shadow(priv->torrentModel),
+                              on_torrent_get_refilter, win);
 
     g_object_set(priv->filterEntry, "secondary-icon-sensitive",
                  clearSensitive, NULL);
 }
 
 static void
-torrent_state_selection_changed(TrgStateSelector *
-                                selector G_GNUC_UNUSED,
-                                guint flag G_GNUC_UNUSED, gpointer data)
+torrent_state_selection_changed(TrgStateSelector * selector,
+                                guint flag, gpointer data)
 {
-    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(data));
+    TrgMainWindowPrivate *priv =
+        trg_main_window_get_instance_private(TRG_MAIN_WINDOW(data));
+
+    trg_torrent_query_set_selector(priv->query, flag,
+                                   trg_state_selector_get_selected_name
+                                   (selector));
+    trg_torrent_sort_model_refilter(TRG_TORRENT_SORT_MODEL
+                                    (priv->sortedTorrentModel));
 }
 
 static void
@@ -1697,6 +2547,7 @@ trg_main_window_conn_changed(TrgMainWindow * win, gboolean connected)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     TrgClient *tc = priv->client;
+    GList *li;
 
     trg_toolbar_connected_change(priv->toolBar, connected);
     trg_menu_bar_connected_change(priv->menuBar, connected);
@@ -1725,11 +2576,26 @@ trg_main_window_conn_changed(TrgMainWindow * win, gboolean connected)
             trg_torrent_graph_set_nothing(priv->graph);
 #endif
 
+        /* As for the first update, the view isn't told about each row
+         * going, it's given the empty model when they've all gone. */
+        gtk_tree_view_set_model(GTK_TREE_VIEW(priv->torrentTreeView),
+                                NULL);
         trg_torrent_model_remove_all(priv->torrentModel);
+        gtk_tree_view_set_model(GTK_TREE_VIEW(priv->torrentTreeView),
+                                priv->sortedTorrentModel);
+        g_array_set_size(priv->fillIds, 0);
+        priv->fillNext = 0;
 
-        g_source_remove(priv->timerId);
+        /* Their responses still come, and free them. */
+        for (li = priv->batches; li; li = g_list_next(li))
+            ((trg_batch *) li->data)->abandoned = TRUE;
+
+        if (priv->timerId > 0)
+            g_source_remove(priv->timerId);
         g_source_remove(priv->sessionTimerId);
         priv->sessionTimerId = priv->timerId = 0;
+        priv->pollInFlight = FALSE;
+        priv->pollInterval = 0;
     }
 
     trg_client_status_change(tc, connected);
@@ -2069,13 +2935,15 @@ static GtkWidget *priority_menu_new(TrgMainWindow * win, JsonArray * ids)
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     TrgClient *client = priv->client;
-    JsonObject *t = NULL;
+    GtkTreeIter iter;
     gint selected_pri = TR_PRI_UNSET;
     GtkWidget *toplevel, *menu;
 
     if (get_torrent_data(trg_client_get_torrent_table(client),
-                         priv->selectedTorrentId, &t, NULL))
-        selected_pri = torrent_get_bandwidth_priority(t);
+                         priv->selectedTorrentId, NULL, &iter))
+        selected_pri =
+            trg_torrent_model_get_int64(priv->torrentModel, &iter,
+                                        TORRENT_COLUMN_BANDWIDTH_PRIORITY);
 
     toplevel = gtk_image_menu_item_new_with_label(GTK_STOCK_NETWORK);
     gtk_image_menu_item_set_use_stock(GTK_IMAGE_MENU_ITEM(toplevel), TRUE);
@@ -2106,21 +2974,32 @@ static GtkWidget *limit_menu_new(TrgMainWindow * win, gchar * title,
 {
     TrgMainWindowPrivate *priv = trg_main_window_get_instance_private(win);
     TrgClient *client = priv->client;
-    JsonObject *current = NULL;
+    JsonObject *current;
     GtkTreeIter iter;
     GtkWidget *toplevel, *menu, *item;
-    gint64 limit;
-
-    if (ids)
-        get_torrent_data(trg_client_get_torrent_table(client),
-                         priv->selectedTorrentId, &current, &iter);
-    else
+    gint64 limit = -1;
+
+    /* A torrent's limits are in its columns, the session's in its JSON. */
+    if (ids) {
+        gboolean down = !g_strcmp0(speedKey, FIELD_DOWNLOAD_LIMIT);
+
+        if (get_torrent_data(trg_client_get_torrent_table(client),
+                             priv->selectedTorrentId, NULL, &iter)
+            && trg_torrent_model_get_int64(priv->torrentModel, &iter,
+                                           down ?
+                                           TORRENT_COLUMN_DOWNLOAD_LIMITED
+                                           :
+                                           TORRENT_COLUMN_UPLOAD_LIMITED))
+            limit = trg_torrent_model_get_int64(priv->torrentModel, &iter,
+                                                down ?
+                                                TORRENT_COLUMN_DOWNLOAD_LIMIT
+                                                :
+                                                TORRENT_COLUMN_UPLOAD_LIMIT);
+    } else {
         current = trg_client_get_session(client);
-
-    limit =
-        json_object_get_boolean_member(current,
-                                       enabledKey) ?
-        json_object_get_int_member(current, speedKey) : -1;
+        if (json_object_get_boolean_member(current, enabledKey))
+            limit = json_object_get_int_member(current, speedKey);
+    }
     toplevel = gtk_image_menu_item_new_with_label(GTK_STOCK_NETWORK);
     gtk_image_menu_item_set_use_stock(GTK_IMAGE_MENU_ITEM(toplevel), TRUE);
     gtk_image_menu_item_set_always_show_image(GTK_IMAGE_MENU_ITEM
@@ -2486,9 +3365,14 @@ static void trg_main_window_set_hidden_to_tray(TrgMainWindow * win,
 
         if (priv->timerId > 0) {
             g_source_remove(priv->timerId);
-            dispatch_async(priv->client,
-                           torrent_get(TORRENT_GET_TAG_MODE_FULL),
-                           on_torrent_get_update, win);
+            priv->timerId = 0;
+            priv->pollInFlight = TRUE;
+            dispatch_async_parsed(priv->client,
+                                  trg_main_window_torrent_get(win,
+                                                              TORRENT_GET_TAG_MODE_FULL),
+                                  torrents_response_parse,
+                                  trg_torrent_model_get_shadow(priv->torrentModel),
+                                  on_torrent_get_update, win);
         }
     }
 
@@ -2757,20 +3641,18 @@ static GObject *trg_main_window_constructor(GType type,
                      G_CALLBACK(on_torrent_added), self);
 
     priv->sortedTorrentModel =
-        gtk_tree_model_sort_new_with_model(GTK_TREE_MODEL
-                                           (priv->torrentModel));
+        trg_torrent_sort_model_new(priv->torrentModel);
+    priv->fillIds = g_array_new(FALSE, FALSE, sizeof(gint64));
 
-    priv->filteredTorrentModel =
-        trg_sortable_filtered_model_new(GTK_TREE_SORTABLE
-                                        (priv->sortedTorrentModel), NULL);
-    gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER
-                                           (priv->filteredTorrentModel),
-                                           trg_torrent_tree_view_visible_func,
-                                           self, NULL);
+    priv->query = trg_torrent_query_compile(NULL);
+    trg_torrent_sort_model_set_visible_func(TRG_TORRENT_SORT_MODEL
+                                            (priv->sortedTorrentModel),
+                                            trg_torrent_tree_view_visible_func,
+                                            self, NULL);
 
     priv->torrentTreeView = trg_main_window_torrent_tree_view_new(self,
                                                                   priv->
-                                                                  filteredTorrentModel);
+                                                                  sortedTorrentModel);
     g_signal_connect(priv->torrentTreeView, "popup-menu",
                      G_CALLBACK(torrent_tv_popup_menu_cb), self);
     g_signal_connect(priv->torrentTreeView, "button-press-event",
@@ -2832,9 +3714,14 @@ static GObject *trg_main_window_constructor(GType type,
 
     g_signal_connect(G_OBJECT(priv->stateSelector),
                      "torrent-state-changed",
-                     G_CALLBACK(torrent_state_selection_changed),
-                     priv->filteredTorrentModel);
-
+                     G_CALLBACK(torrent_state_selection_changed), self);
+    trg_torrent_query_set_selector(priv->query,
+                                   trg_state_selector_get_flag
+                                   (priv->stateSelector),
+                                   trg_state_selector_get_selected_name
+                                   (priv->stateSelector));
+
+    priv->notebookTorrentId = -1;
     priv->notebook = trg_main_window_notebook_new(self);
     gtk_paned_pack2(GTK_PANED(priv->vpaned), priv->notebook, FALSE, FALSE);
 
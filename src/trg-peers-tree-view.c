@@ -102,7 +102,7 @@ TrgPeersTreeView *trg_peers_tree_view_new(TrgPrefs * prefs,
     trg_peers_tree_view_setup_columns(TRG_PEERS_TREE_VIEW(obj), model);
 
     gtk_tree_view_set_model(GTK_TREE_VIEW(obj), GTK_TREE_MODEL(model));
-    trg_tree_view_restore_sort(TRG_TREE_VIEW(obj), 0x00);
+    trg_tree_view_restore_sort(TRG_TREE_VIEW(obj));
     trg_tree_view_setup_columns(TRG_TREE_VIEW(obj));
 
 #ifdef HAVE_GEOIP
@@ -888,6 +888,10 @@ static GtkWidget *trg_prefs_serverPage(TrgPreferencesDialog * dlg)
                       TRG_PREFS_PROFILE, NULL);
     hig_workarea_add_row(t, &row, _("Retries:"), w, NULL);
 
+    w = trgp_spin_new(dlg, TRG_PREFS_KEY_BATCH_SIZE, 1, INT_MAX, 100,
+                      TRG_PREFS_PROFILE, NULL);
+    hig_workarea_add_row(t, &row, _("Torrents per request:"), w, NULL);
+
     frame = gtk_frame_new(NULL);
     frameHbox = trg_hbox_new(FALSE, 2);
     gtk_box_pack_start(GTK_BOX(frameHbox), profileLabel, FALSE, FALSE, 2);
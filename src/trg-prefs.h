@@ -28,6 +28,7 @@
 #define TRG_PORT_DEFAULT            9091
 #define TRG_INTERVAL_DEFAULT        3
 #define TRG_SESSION_INTERVAL_DEFAULT 60
+#define TRG_BATCH_SIZE_DEFAULT      500
 #define TRG_PROFILE_NAME_DEFAULT   "Default"
 
 #define TRG_PREFS_KEY_RPC_URL_PATH "rpc-url-path"
@@ -45,6 +46,7 @@
 #define TRG_PREFS_KEY_SSL_VALIDATE   "ssl-validate"
 #define TRG_PREFS_KEY_TIMEOUT            "timeout"
 #define TRG_PREFS_KEY_RETRIES            "retries"
+#define TRG_PREFS_KEY_BATCH_SIZE         "batch-size"
 #define TRG_PREFS_KEY_UPDATE_INTERVAL "update-interval"
 #define TRG_PREFS_KEY_SESSION_UPDATE_INTERVAL "session-update-interval"
 #define TRG_PREFS_KEY_COMPLETE_NOTIFY "complete-notify"
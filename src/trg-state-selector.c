@@ -27,6 +27,7 @@
 #include <gtk/gtk.h>
 
 #include "torrent.h"
+#include "protocol-constants.h"
 #include "trg-cell-renderer-counter.h"
 #include "trg-state-selector.h"
 #include "trg-torrent-model.h"
@@ -55,10 +56,11 @@ struct _TrgStateSelectorPrivate {
     gboolean showTrackers;
     gboolean dirsFirst;
     TrgClient *client;
+    TrgTorrentModel *torrentModel;
     TrgPrefs *prefs;
     GHashTable *trackers;
     GHashTable *directories;
-    GRegex *urlHostRegex;
+    const gchar *selectedName;
     gint n_categories;
     GtkListStore *store;
     GtkTreeRowReference *error_rr;
@@ -74,12 +76,6 @@ struct _TrgStateSelectorPrivate {
     GtkTreeRowReference *down_wait_rr;
 };
 
-GRegex *trg_state_selector_get_url_host_regex(TrgStateSelector * s)
-{
-    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
-    return priv->urlHostRegex;
-}
-
 guint32 trg_state_selector_get_flag(TrgStateSelector * s)
 {
     TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
@@ -96,11 +92,22 @@ state_selection_changed(GtkTreeSelection * selection, gpointer data)
 
     priv = TRG_STATE_SELECTOR_GET_PRIVATE(data);
 
-    if (gtk_tree_selection_get_selected(selection, &stateModel, &iter))
+    priv->selectedName = NULL;
+
+    if (gtk_tree_selection_get_selected(selection, &stateModel, &iter)) {
         gtk_tree_model_get(stateModel, &iter, STATE_SELECTOR_BIT,
                            &priv->flag, STATE_SELECTOR_INDEX, &index, -1);
-    else
+
+        if (priv->flag & (FILTER_FLAG_TRACKER | FILTER_FLAG_DIR)) {
+            gchar *name;
+            gtk_tree_model_get(stateModel, &iter, STATE_SELECTOR_NAME,
+                               &name, -1);
+            priv->selectedName = g_intern_string(name);
+            g_free(name);
+        }
+    } else {
         priv->flag = 0;
+    }
 
     trg_prefs_set_int(priv->prefs, TRG_PREFS_STATE_SELECTOR_LAST, index,
                       TRG_PREFS_GLOBAL);
@@ -118,88 +125,20 @@ static GtkTreeRowReference *quick_tree_ref_new(GtkTreeModel * model,
     return rr;
 }
 
-struct cruft_remove_args {
-    GHashTable *table;
-    gint64 serial;
-};
-
-static gboolean
-trg_state_selector_remove_cruft(gpointer key, gpointer value,
-                                gpointer data)
-{
-    struct cruft_remove_args *args = (struct cruft_remove_args *) data;
-    GtkTreeRowReference *rr = (GtkTreeRowReference *) value;
-    GtkTreeModel *model = gtk_tree_row_reference_get_model(rr);
-    GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-    gboolean remove;
-
-    GtkTreeIter iter;
-    gint64 currentSerial;
-
-    gtk_tree_model_get_iter(model, &iter, path);
-    gtk_tree_model_get(model, &iter, STATE_SELECTOR_SERIAL, &currentSerial,
-                       -1);
-
-    remove = (args->serial != currentSerial);
-
-    gtk_tree_path_free(path);
-
-    return remove;
-}
-
-gchar *trg_state_selector_get_selected_text(TrgStateSelector * s)
-{
-    GtkTreeSelection *sel = gtk_tree_view_get_selection(GTK_TREE_VIEW(s));
-    GtkTreeModel *model;
-    GtkTreeIter iter;
-    gchar *name = NULL;
-
-    if (gtk_tree_selection_get_selected(sel, &model, &iter))
-        gtk_tree_model_get(model, &iter, STATE_SELECTOR_NAME, &name, -1);
-
-    return name;
-}
+/* The tracker host or directory selected, interned so it can be compared
+ * with the torrent model's by pointer. NULL for anything else. */
 
-static void
-trg_state_selector_update_dynamic_filter(GtkTreeModel * model,
-                                         GtkTreeRowReference *
-                                         rr, gint64 serial)
+const gchar *trg_state_selector_get_selected_name(TrgStateSelector * s)
 {
-    GtkTreeIter iter;
-    GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-    gint64 oldSerial;
-    GValue gvalue = G_VALUE_INIT;
-    gint oldCount;
-
-    gtk_tree_model_get_iter(model, &iter, path);
-    gtk_tree_model_get(model, &iter, STATE_SELECTOR_SERIAL, &oldSerial,
-                       STATE_SELECTOR_COUNT, &oldCount, -1);
-
-    if (oldSerial != serial) {
-        g_value_init(&gvalue, G_TYPE_INT);
-        g_value_set_int(&gvalue, 1);
-        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
-                                 STATE_SELECTOR_COUNT, &gvalue);
-
-        memset(&gvalue, 0, sizeof(GValue));
-        g_value_init(&gvalue, G_TYPE_INT64);
-        g_value_set_int64(&gvalue, serial);
-        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
-                                 STATE_SELECTOR_SERIAL, &gvalue);
-    } else {
-        g_value_init(&gvalue, G_TYPE_INT);
-        g_value_set_int(&gvalue, ++oldCount);
-        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
-                                 STATE_SELECTOR_COUNT, &gvalue);
-    }
-
-    gtk_tree_path_free(path);
+    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
+    return priv->selectedName;
 }
 
 static void refresh_statelist_cb(GtkWidget * w, gpointer data)
 {
     TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(data);
-    trg_client_inc_serial(priv->client);
+    g_hash_table_remove_all(priv->trackers);
+    g_hash_table_remove_all(priv->directories);
     trg_state_selector_update(TRG_STATE_SELECTOR(data),
                               TORRENT_UPDATE_ADDREMOVE);
 }
@@ -297,148 +236,115 @@ trg_state_selector_insert(TrgStateSelector * s, int offset,
     gtk_list_store_insert(GTK_LIST_STORE(model), iter, args.pos);
 }
 
-void trg_state_selector_update(TrgStateSelector * s, guint whatsChanged)
+static void
+trg_state_selector_update_stat(GtkTreeRowReference * rr, gint count)
+{
+    if (rr) {
+        GValue gvalue = G_VALUE_INIT;
+        GtkTreeIter iter;
+        GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
+        GtkTreeModel *model = gtk_tree_row_reference_get_model(rr);
+
+        gtk_tree_model_get_iter(model, &iter, path);
+
+        g_value_init(&gvalue, G_TYPE_INT);
+        g_value_set_int(&gvalue, count);
+        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
+                                 STATE_SELECTOR_COUNT, &gvalue);
+
+        gtk_tree_path_free(path);
+    }
+}
+
+/* Bring the tracker or directory row for name into line with how many
+ * torrents have it, adding or removing the row as needed.
+ */
+
+static void
+trg_state_selector_update_facet_row(TrgStateSelector * s, gint facet,
+                                    const gchar * name, gint count)
 {
     TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
     GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(s));
-    TrgClient *client = priv->client;
-    gint64 updateSerial = trg_client_get_serial(client);
-    GList *torrentItemRefs;
-    GtkTreeIter torrentIter, iter;
-    GList *trackersList, *trackerItem, *li;
-    GtkTreeRowReference *rr;
-    GtkTreePath *path;
-    GtkTreeModel *torrentModel;
-    gpointer result;
-    struct cruft_remove_args cruft;
-
-    if (!trg_client_is_connected(client))
+    gboolean tracker = facet == TORRENT_FACET_TRACKER;
+    GHashTable *rows = tracker ? priv->trackers : priv->directories;
+    GtkTreeRowReference *rr = g_hash_table_lookup(rows, name);
+    GtkTreeIter iter;
+
+    if (count < 1) {
+        if (rr)
+            g_hash_table_remove(rows, name);
+        return;
+    } else if (rr) {
+        trg_state_selector_update_stat(rr, count);
         return;
+    }
 
-    torrentItemRefs =
-        g_hash_table_get_values(trg_client_get_torrent_table(client));
-
-    for (li = torrentItemRefs; li; li = g_list_next(li)) {
-        JsonObject *t = NULL;
-        rr = (GtkTreeRowReference *) li->data;
-        path = gtk_tree_row_reference_get_path(rr);
-        torrentModel = gtk_tree_row_reference_get_model(rr);
-
-        if (path) {
-            if (gtk_tree_model_get_iter(torrentModel, &torrentIter, path)) {
-                gtk_tree_model_get(torrentModel, &torrentIter,
-                                   TORRENT_COLUMN_JSON, &t, -1);
-            }
-            gtk_tree_path_free(path);
-        }
+    if (tracker ? priv->dirsFirst : !priv->dirsFirst)
+        trg_state_selector_insert(s, priv->n_categories +
+                                  g_hash_table_size(tracker ?
+                                                    priv->directories :
+                                                    priv->trackers), -1,
+                                  name, &iter);
+    else
+        trg_state_selector_insert(s, priv->n_categories,
+                                  g_hash_table_size(rows), name, &iter);
+
+    gtk_list_store_set(GTK_LIST_STORE(model), &iter,
+                       STATE_SELECTOR_ICON,
+                       tracker ? GTK_STOCK_NETWORK : GTK_STOCK_DIRECTORY,
+                       STATE_SELECTOR_NAME, name,
+                       STATE_SELECTOR_COUNT, count,
+                       STATE_SELECTOR_BIT,
+                       tracker ? FILTER_FLAG_TRACKER : FILTER_FLAG_DIR,
+                       STATE_SELECTOR_INDEX, 0, -1);
+    g_hash_table_insert(rows, g_strdup(name),
+                        quick_tree_ref_new(model, &iter));
+}
 
-        if (!t)
-            continue;
-
-        if (priv->showTrackers
-            && (whatsChanged & TORRENT_UPDATE_ADDREMOVE)) {
-            trackersList =
-                json_array_get_elements(torrent_get_tracker_stats(t));
-            for (trackerItem = trackersList; trackerItem;
-                 trackerItem = g_list_next(trackerItem)) {
-                JsonObject *tracker =
-                    json_node_get_object((JsonNode *) trackerItem->data);
-                const gchar *announceUrl =
-                    tracker_stats_get_announce(tracker);
-                gchar *announceHost =
-                    trg_gregex_get_first(priv->urlHostRegex,
-                                         announceUrl);
-
-                if (!announceHost)
-                    continue;
-
-                result = g_hash_table_lookup(priv->trackers, announceHost);
-
-                if (result) {
-                    trg_state_selector_update_dynamic_filter(model,
-                                                             (GtkTreeRowReference
-                                                              *) result,
-                                                             updateSerial);
-                    g_free(announceHost);
-                } else {
-					if (priv->dirsFirst){
-							trg_state_selector_insert(s, priv->n_categories +
-										g_hash_table_size(priv->directories), -1, announceHost, &iter);
-					} else {
-						trg_state_selector_insert(s, priv->n_categories,
-										g_hash_table_size(priv->trackers), announceHost, &iter);
-					}
-                    gtk_list_store_set(GTK_LIST_STORE(model), &iter,
-                                       STATE_SELECTOR_ICON,
-                                       GTK_STOCK_NETWORK,
-                                       STATE_SELECTOR_NAME, announceHost,
-                                       STATE_SELECTOR_SERIAL, updateSerial,
-                                       STATE_SELECTOR_COUNT, 1,
-                                       STATE_SELECTOR_BIT,
-                                       FILTER_FLAG_TRACKER,
-                                       STATE_SELECTOR_INDEX, 0, -1);
-                    g_hash_table_insert(priv->trackers, announceHost,
-                                        quick_tree_ref_new(model, &iter));
-                }
-            }
-            g_list_free(trackersList);
-        }
+/* The torrent model keeps count of torrents by tracker host and directory,
+ * and which of those counts the last update changed, so only rows for
+ * those need looking at. With no rows yet, go through all of them.
+ */
 
-        if (priv->showDirs && ((whatsChanged & TORRENT_UPDATE_ADDREMOVE)
-                               || (whatsChanged &
-                                   TORRENT_UPDATE_PATH_CHANGE))) {
-            gchar *dir;
-            gtk_tree_model_get(torrentModel, &torrentIter,
-                               TORRENT_COLUMN_DOWNLOADDIR_SHORT, &dir, -1);
-
-            result = g_hash_table_lookup(priv->directories, dir);
-            if (result) {
-                trg_state_selector_update_dynamic_filter(model,
-                                                         (GtkTreeRowReference
-                                                          *) result,
-                                                         updateSerial);
-            } else {
-                if (priv->dirsFirst){
-					trg_state_selector_insert(s, priv->n_categories,
-								g_hash_table_size(priv->directories), dir, &iter);
-				} else {
-					trg_state_selector_insert(s, priv->n_categories +
-									g_hash_table_size(priv->trackers), -1, dir, &iter);
-				}
-                gtk_list_store_set(GTK_LIST_STORE(model), &iter,
-                                   STATE_SELECTOR_ICON,
-                                   GTK_STOCK_DIRECTORY,
-                                   STATE_SELECTOR_NAME, dir,
-                                   STATE_SELECTOR_SERIAL, updateSerial,
-                                   STATE_SELECTOR_BIT, FILTER_FLAG_DIR,
-                                   STATE_SELECTOR_COUNT, 1,
-                                   STATE_SELECTOR_INDEX, 0, -1);
-                g_hash_table_insert(priv->directories, g_strdup(dir),
-                                    quick_tree_ref_new(model, &iter));
-            }
-
-            g_free(dir);
-        }
-    }
+static void
+trg_state_selector_update_facet(TrgStateSelector * s, gint facet)
+{
+    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
+    GHashTable *rows = facet == TORRENT_FACET_TRACKER ?
+        priv->trackers : priv->directories;
+    GHashTable *counts =
+        trg_torrent_model_get_facet(priv->torrentModel, facet);
+    GHashTable *names = g_hash_table_size(rows) > 0 ?
+        trg_torrent_model_get_facet_changes(priv->torrentModel, facet) :
+        counts;
+    GHashTableIter hiter;
+    gpointer name;
+
+    g_hash_table_iter_init(&hiter, names);
+    while (g_hash_table_iter_next(&hiter, &name, NULL))
+        trg_state_selector_update_facet_row(s, facet,
+                                            (const gchar *) name,
+                                            GPOINTER_TO_INT
+                                            (g_hash_table_lookup
+                                             (counts, name)));
+}
 
-    g_list_free(torrentItemRefs);
+void trg_state_selector_update(TrgStateSelector * s, guint whatsChanged)
+{
+    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
 
-    cruft.serial = trg_client_get_serial(client);
+    if (!trg_client_is_connected(priv->client) || !priv->torrentModel)
+        return;
 
-    if (priv->showTrackers && ((whatsChanged & TORRENT_UPDATE_ADDREMOVE))) {
-        cruft.table = priv->trackers;
-        g_hash_table_foreach_remove(priv->trackers,
-                                    trg_state_selector_remove_cruft,
-                                    &cruft);
-    }
+    if (priv->showTrackers
+        && (whatsChanged & (TORRENT_UPDATE_ADDREMOVE |
+                            TORRENT_UPDATE_TRACKER_CHANGE)))
+        trg_state_selector_update_facet(s, TORRENT_FACET_TRACKER);
 
     if (priv->showDirs && ((whatsChanged & TORRENT_UPDATE_ADDREMOVE)
-                           || (whatsChanged & TORRENT_UPDATE_PATH_CHANGE))) {
-        cruft.table = priv->directories;
-        g_hash_table_foreach_remove(priv->directories,
-                                    trg_state_selector_remove_cruft,
-                                    &cruft);
-    }
+                           || (whatsChanged & TORRENT_UPDATE_PATH_CHANGE)))
+        trg_state_selector_update_facet(s, TORRENT_FACET_DIR);
 }
 
 void trg_state_selector_set_show_dirs(TrgStateSelector * s, gboolean show)
@@ -476,6 +382,16 @@ trg_state_selector_set_show_trackers(TrgStateSelector * s, gboolean show)
         trg_state_selector_update(s, TORRENT_UPDATE_ADDREMOVE);
 }
 
+/* The torrent-get fields needed to list and filter by tracker. Directories
+ * only need the download dir, which is always polled. */
+
+guint64 trg_state_selector_get_fields(TrgStateSelector * s)
+{
+    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
+    return priv->showTrackers ?
+        TORRENT_FIELD_BIT(TORRENT_FIELD_TRACKER_STATS) : 0;
+}
+
 void
 trg_state_selector_set_directories_first(TrgStateSelector * s, gboolean _dirsFirst){
 	TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(s);
@@ -526,26 +442,6 @@ static void remove_row_ref_and_free(GtkTreeRowReference * rr)
     gtk_tree_row_reference_free(rr);
 }
 
-static void
-trg_state_selector_update_stat(GtkTreeRowReference * rr, gint count)
-{
-    if (rr) {
-        GValue gvalue = G_VALUE_INIT;
-        GtkTreeIter iter;
-        GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-        GtkTreeModel *model = gtk_tree_row_reference_get_model(rr);
-
-        gtk_tree_model_get_iter(model, &iter, path);
-
-        g_value_init(&gvalue, G_TYPE_INT);
-        g_value_set_int(&gvalue, count);
-        gtk_list_store_set_value(GTK_LIST_STORE(model), &iter,
-                                 STATE_SELECTOR_COUNT, &gvalue);
-
-        gtk_tree_path_free(path);
-    }
-}
-
 void
 trg_state_selector_stats_update(TrgStateSelector * s,
                                 trg_torrent_model_update_stats * stats)
@@ -610,6 +506,9 @@ TrgStateSelector *trg_state_selector_new(TrgClient * client,
     TrgStateSelector *selector =
         g_object_new(TRG_TYPE_STATE_SELECTOR, "client",
                      client, NULL);
+    TrgStateSelectorPrivate *priv = TRG_STATE_SELECTOR_GET_PRIVATE(selector);
+
+    priv->torrentModel = tmodel;
     g_signal_connect(tmodel, "torrents-state-change",
                      G_CALLBACK(on_torrents_state_change), selector);
     return selector;
@@ -639,7 +538,6 @@ static GObject *trg_state_selector_constructor(GType type,
     selector = TRG_STATE_SELECTOR(object);
     priv = TRG_STATE_SELECTOR_GET_PRIVATE(object);
 
-    priv->urlHostRegex = trg_uri_host_regex_new();
     priv->trackers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
                                            (GDestroyNotify)
                                            remove_row_ref_and_free);
@@ -668,7 +566,7 @@ static GObject *trg_state_selector_constructor(GType type,
     store = priv->store = gtk_list_store_new(STATE_SELECTOR_COLUMNS,
                                              G_TYPE_STRING, G_TYPE_STRING,
                                              G_TYPE_INT, G_TYPE_UINT,
-                                             G_TYPE_INT64, G_TYPE_UINT);
+                                             G_TYPE_UINT);
     gtk_tree_view_set_model(GTK_TREE_VIEW(object), GTK_TREE_MODEL(store));
 
     trg_state_selector_add_state(selector, &iter, -1, GTK_STOCK_ABOUT,
@@ -31,7 +31,6 @@ enum {
     STATE_SELECTOR_NAME,
     STATE_SELECTOR_COUNT,
     STATE_SELECTOR_BIT,
-    STATE_SELECTOR_SERIAL,
     STATE_SELECTOR_INDEX,
     STATE_SELECTOR_COLUMNS
 };
@@ -66,13 +65,13 @@ TrgStateSelector *trg_state_selector_new(TrgClient * client,
 
 G_END_DECLS guint32 trg_state_selector_get_flag(TrgStateSelector * s);
 void trg_state_selector_update(TrgStateSelector * s, guint whatsChanged);
-gchar *trg_state_selector_get_selected_text(TrgStateSelector * s);
-GRegex *trg_state_selector_get_url_host_regex(TrgStateSelector * s);
+const gchar *trg_state_selector_get_selected_name(TrgStateSelector * s);
 void trg_state_selector_disconnect(TrgStateSelector * s);
 void trg_state_selector_set_show_trackers(TrgStateSelector * s,
                                           gboolean show);
 void trg_state_selector_set_directories_first(TrgStateSelector * s, gboolean _dirsFirst);
 void trg_state_selector_set_show_dirs(TrgStateSelector * s, gboolean show);
+guint64 trg_state_selector_get_fields(TrgStateSelector * s);
 void trg_state_selector_set_queues_enabled(TrgStateSelector * s,
                                            gboolean enabled);
 void trg_state_selector_stats_update(TrgStateSelector * s,
@@ -55,6 +55,8 @@ struct _TrgStatusBarPrivate {
     GtkWidget *turtleImage, *turtleEventBox;
     GtkWidget *free_lbl;
     GtkWidget *info_lbl;
+    GtkWidget *progress_lbl;
+    GtkWidget *poll_lbl;
     TrgClient *client;
     TrgMainWindow *win;
 };
@@ -76,6 +78,8 @@ void trg_status_bar_reset(TrgStatusBar * sb)
     TrgStatusBarPrivate *priv = TRG_STATUS_BAR_GET_PRIVATE(sb);
     trg_status_bar_clear_indicators(sb);
     gtk_label_set_text(GTK_LABEL(priv->info_lbl), _("Disconnected"));
+    gtk_label_set_text(GTK_LABEL(priv->progress_lbl), "");
+    gtk_label_set_text(GTK_LABEL(priv->poll_lbl), "");
     gtk_widget_set_visible(priv->turtleEventBox, FALSE);
 }
 
@@ -108,6 +112,9 @@ static void trg_status_bar_init(TrgStatusBar * self)
     priv->info_lbl = gtk_label_new(_("Disconnected"));
     gtk_box_pack_start(GTK_BOX(self), priv->info_lbl, FALSE, TRUE, 0);
 
+    priv->progress_lbl = gtk_label_new(NULL);
+    gtk_box_pack_start(GTK_BOX(self), priv->progress_lbl, FALSE, TRUE, 10);
+
     priv->turtleImage = gtk_image_new();
 
     priv->turtleEventBox = gtk_event_box_new();
@@ -123,6 +130,9 @@ static void trg_status_bar_init(TrgStatusBar * self)
 
     priv->free_lbl = gtk_label_new(NULL);
     gtk_box_pack_end(GTK_BOX(self), priv->free_lbl, FALSE, TRUE, 30);
+
+    priv->poll_lbl = gtk_label_new(NULL);
+    gtk_box_pack_end(GTK_BOX(self), priv->poll_lbl, FALSE, TRUE, 10);
 }
 
 void
@@ -132,6 +142,24 @@ trg_status_bar_push_connection_msg(TrgStatusBar * sb, const gchar * msg)
     gtk_label_set_text(GTK_LABEL(priv->info_lbl), msg);
 }
 
+/* How far an action on many torrents has got, or NULL when it's done.
+ * The connection message is replaced on every update, so it has its own
+ * label. */
+
+void trg_status_bar_set_progress(TrgStatusBar * sb, const gchar * msg)
+{
+    TrgStatusBarPrivate *priv = TRG_STATUS_BAR_GET_PRIVATE(sb);
+    gtk_label_set_text(GTK_LABEL(priv->progress_lbl), msg ? msg : "");
+}
+
+/* When the next torrent-get is, and why, see trg_main_window_adapt_poll(). */
+
+void trg_status_bar_set_poll_info(TrgStatusBar * sb, const gchar * msg)
+{
+    TrgStatusBarPrivate *priv = TRG_STATUS_BAR_GET_PRIVATE(sb);
+    gtk_label_set_text(GTK_LABEL(priv->poll_lbl), msg ? msg : "");
+}
+
 static void
 trg_status_bar_set_connected_label(TrgStatusBar * sb, JsonObject * session,
                                    TrgClient * client)
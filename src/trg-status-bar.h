@@ -59,6 +59,8 @@ void trg_status_bar_connect(TrgStatusBar * sb, JsonObject * session,
                             TrgClient * client);
 void trg_status_bar_push_connection_msg(TrgStatusBar * sb,
                                         const gchar * msg);
+void trg_status_bar_set_progress(TrgStatusBar * sb, const gchar * msg);
+void trg_status_bar_set_poll_info(TrgStatusBar * sb, const gchar * msg);
 void trg_status_bar_reset(TrgStatusBar * sb);
 void trg_status_bar_clear_indicators(TrgStatusBar * sb);
 const gchar *trg_status_bar_get_speed_text(TrgStatusBar * s);
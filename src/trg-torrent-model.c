@@ -33,17 +33,19 @@
 #include "trg-model.h"
 #include "util.h"
 
-/* An extension of TrgModel (which is an extension of GtkListStore) which
- * updates from a JSON torrent-get response. It handles a number of different
- * update modes.
- *   1) The first update.
+/* A GtkTreeModel of its own, a column array per column rather than a
+ * GtkListStore of GValues, which updates from a JSON torrent-get response.
+ * It handles a number of different update modes.
+ *   1) The first update, which makes room for every row at once.
  *   2) A full update.
  *   3) An active-only update.
  *   4) Individual torrent updates.
  *
  * Other stuff it does.
  *   1) Populates a stats struct with speeds/state counts as it works through the
- *      response.
+ *      response. Counts move with each row's change of flags, and the speed
+ *      totals with each row's change of rate, rather than from a scan of
+ *      every row or only the rows in the last response.
  *   2) Emits signals if something is added or removed. This is used by the state
  *      selector so it doesn't have to refresh itself on every update.
  *   3) Added or completed signals, for libnotify notifications.
@@ -51,7 +53,30 @@
  *      (and provide a lookup function which outputs an iter and/or JSON object.)
  *   5) If the download directory is new/changed, create a short version if there
  *      is one (duplicate it not) for the state selector to filter/populate against.
+ *      Each directory is only shortened once.
  *   6) Shorten the tracker announce URL.
+ *   7) Keep the detail fields (files, peers...) of the torrent they were last
+ *      requested for across list polls, which don't include them. That's
+ *      the only row with a JSON object, the rest only have their columns.
+ *   8) Only update the columns whose fields are in the response. The list
+ *      poll leaves out fields for columns nobody is looking at.
+ *   9) Rows are filled from the records torrents_response_parse() made on
+ *      the worker thread, which reads both the table and object formats,
+ *      and works out the flags and status strings.
+ *  10) Rows the worker thread's shadow found unchanged aren't touched at all,
+ *      and it works out what was removed from a full update. Records older
+ *      than the one a row was filled from are rejected, and only records
+ *      that are applied get committed to the shadow.
+ *  11) Of the rows that did change, only set the columns that differ.
+ *  12) Typed accessors for the flags, JSON and strings, for callers that
+ *      would otherwise copy them out through gtk_tree_model_get().
+ *  13) Counts torrents by tracker host and short download directory as rows
+ *      come, go and change, for the state selector.
+ *  14) Keeps each name casefolded, and whether it matches the filter text,
+ *      so a row's name is only folded and searched when it changes.
+ *  15) Typed comparison of two rows by a column, for the sorted view.
+ *      Strings compare by collation key, made once per interned value or
+ *      once per row until its string changes.
  */
 
 enum {
@@ -66,29 +91,981 @@ enum {
 
 static guint signals[TMODEL_SIGNAL_COUNT] = { 0 };
 
-G_DEFINE_TYPE(TrgTorrentModel, trg_torrent_model, GTK_TYPE_LIST_STORE)
+static void trg_torrent_model_tree_model_init(GtkTreeModelIface * iface);
+
+G_DEFINE_TYPE_WITH_CODE(TrgTorrentModel, trg_torrent_model, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+                                              trg_torrent_model_tree_model_init))
 #define TRG_TORRENT_MODEL_GET_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_TORRENT_MODEL, TrgTorrentModelPrivate))
 typedef struct _TrgTorrentModelPrivate TrgTorrentModelPrivate;
 
+/* Rows are kept a column at a time, each column an array of its own type
+ * indexed by the row's slot. A row keeps its slot for as long as it
+ * exists, and that's what an iter holds, so iters persist. Order maps a
+ * position in the list to a slot, positions goes the other way but is
+ * only brought up to date from dirtyFrom when something asks for it.
+ */
+
 struct _TrgTorrentModelPrivate {
     GHashTable *ht;
-    GRegex *urlHostRegex;
+    trg_torrents_shadow *shadow;
     trg_torrent_model_update_stats stats;
+    gint64 detailId;
+
+    gint stamp;
+    gpointer columns[TORRENT_COLUMN_COLUMNS];
+    guint slots;
+    guint capacity;
+    guint *positions;
+    guint dirtyFrom;
+    GArray *order;
+    GArray *freeSlots;
+
+    GHashTable *facets[TORRENT_FACET_COUNT];
+    GHashTable *facetChanges[TORRENT_FACET_COUNT];
+
+    gchar *nameFilter;
+    gchar **foldedNames;
+    gboolean *nameMatches;
+
+    gchar **collateKeys[TORRENT_COLUMN_COLUMNS];
+    GHashTable *internedKeys;
+
+    GHashTable *shortDirs;
 };
 
+static const GType column_types[TORRENT_COLUMN_COLUMNS] = {
+    [TORRENT_COLUMN_ICON] = G_TYPE_STRING,
+    [TORRENT_COLUMN_NAME] = G_TYPE_STRING,
+    [TORRENT_COLUMN_ERROR] = G_TYPE_INT64,
+    [TORRENT_COLUMN_SIZEWHENDONE] = G_TYPE_INT64,
+    [TORRENT_COLUMN_TOTALSIZE] = G_TYPE_INT64,
+    [TORRENT_COLUMN_HAVE_UNCHECKED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_PERCENTDONE] = G_TYPE_DOUBLE,
+    [TORRENT_COLUMN_METADATAPERCENTCOMPLETE] = G_TYPE_DOUBLE,
+    [TORRENT_COLUMN_STATUS] = G_TYPE_STRING,
+    [TORRENT_COLUMN_SEEDS] = G_TYPE_INT64,
+    [TORRENT_COLUMN_LEECHERS] = G_TYPE_INT64,
+    [TORRENT_COLUMN_DOWNLOADS] = G_TYPE_INT64,
+    [TORRENT_COLUMN_DOWNSPEED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_ADDED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_UPSPEED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_ETA] = G_TYPE_INT64,
+    [TORRENT_COLUMN_UPLOADED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_DOWNLOADED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_HAVE_VALID] = G_TYPE_INT64,
+    [TORRENT_COLUMN_RATIO] = G_TYPE_DOUBLE,
+    [TORRENT_COLUMN_ID] = G_TYPE_INT64,
+    [TORRENT_COLUMN_JSON] = G_TYPE_POINTER,
+    [TORRENT_COLUMN_VERSION] = G_TYPE_UINT,
+    [TORRENT_COLUMN_FLAGS] = G_TYPE_INT,
+    [TORRENT_COLUMN_DOWNLOADDIR] = G_TYPE_STRING,
+    [TORRENT_COLUMN_DOWNLOADDIR_SHORT] = G_TYPE_STRING,
+    [TORRENT_COLUMN_BANDWIDTH_PRIORITY] = G_TYPE_INT64,
+    [TORRENT_COLUMN_DONE_DATE] = G_TYPE_INT64,
+    [TORRENT_COLUMN_FROMPEX] = G_TYPE_INT64,
+    [TORRENT_COLUMN_FROMDHT] = G_TYPE_INT64,
+    [TORRENT_COLUMN_FROMTRACKERS] = G_TYPE_INT64,
+    [TORRENT_COLUMN_FROMLTEP] = G_TYPE_INT64,
+    [TORRENT_COLUMN_FROMRESUME] = G_TYPE_INT64,
+    [TORRENT_COLUMN_FROMINCOMING] = G_TYPE_INT64,
+    [TORRENT_COLUMN_PEER_SOURCES] = G_TYPE_STRING,
+    [TORRENT_COLUMN_SEED_RATIO_LIMIT] = G_TYPE_DOUBLE,
+    [TORRENT_COLUMN_SEED_RATIO_MODE] = G_TYPE_INT64,
+    [TORRENT_COLUMN_PEERS_CONNECTED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_PEERS_FROM_US] = G_TYPE_INT64,
+    [TORRENT_COLUMN_WEB_SEEDS_TO_US] = G_TYPE_INT64,
+    [TORRENT_COLUMN_PEERS_TO_US] = G_TYPE_INT64,
+    [TORRENT_COLUMN_TRACKERHOST] = G_TYPE_STRING,
+    [TORRENT_COLUMN_QUEUE_POSITION] = G_TYPE_INT64,
+    [TORRENT_COLUMN_LASTACTIVE] = G_TYPE_INT64,
+    [TORRENT_COLUMN_FILECOUNT] = G_TYPE_UINT,
+    [TORRENT_COLUMN_TRACKER_HOSTS] = G_TYPE_POINTER,
+    [TORRENT_COLUMN_ERROR_STRING] = G_TYPE_STRING,
+    [TORRENT_COLUMN_HASH_STRING] = G_TYPE_STRING,
+    [TORRENT_COLUMN_UPLOAD_LIMIT] = G_TYPE_INT64,
+    [TORRENT_COLUMN_UPLOAD_LIMITED] = G_TYPE_INT64,
+    [TORRENT_COLUMN_DOWNLOAD_LIMIT] = G_TYPE_INT64,
+    [TORRENT_COLUMN_DOWNLOAD_LIMITED] = G_TYPE_INT64,
+};
+
+#define ITER_SLOT(iter) (GPOINTER_TO_UINT((iter)->user_data) - 1)
+#define COLUMN_DATA(priv, type, column) ((type *) (priv)->columns[(column)])
+
+/* Strings that only ever take a handful of values are interned, the rest
+ * are owned by the row. */
+
+static gboolean trg_torrent_model_column_interned(gint column)
+{
+    switch (column) {
+    case TORRENT_COLUMN_ICON:
+    case TORRENT_COLUMN_STATUS:
+    case TORRENT_COLUMN_DOWNLOADDIR:
+    case TORRENT_COLUMN_DOWNLOADDIR_SHORT:
+    case TORRENT_COLUMN_TRACKERHOST:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+/* The owned strings, which keep a collation key per row. */
+
+static gboolean trg_torrent_model_column_keyed(gint column)
+{
+    return column_types[column] == G_TYPE_STRING
+        && !trg_torrent_model_column_interned(column);
+}
+
+static gsize trg_torrent_model_column_size(gint column)
+{
+    switch (column_types[column]) {
+    case G_TYPE_INT:
+        return sizeof(gint);
+    case G_TYPE_UINT:
+        return sizeof(guint);
+    case G_TYPE_INT64:
+        return sizeof(gint64);
+    case G_TYPE_DOUBLE:
+        return sizeof(gdouble);
+    default:
+        return sizeof(gpointer);
+    }
+}
+
+static void
+trg_torrent_model_set_iter(TrgTorrentModelPrivate * priv,
+                           GtkTreeIter * iter, guint slot)
+{
+    iter->stamp = priv->stamp;
+    iter->user_data = GUINT_TO_POINTER(slot + 1);
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
+
+static guint
+trg_torrent_model_position(TrgTorrentModelPrivate * priv, guint slot)
+{
+    if (priv->positions[slot] >= priv->dirtyFrom) {
+        guint i;
+
+        for (i = priv->dirtyFrom; i < priv->order->len; i++)
+            priv->positions[g_array_index(priv->order, guint, i)] = i;
+
+        priv->dirtyFrom = G_MAXUINT;
+    }
+
+    return priv->positions[slot];
+}
+
+/* Make room for at least this many slots, doubling as the model grows
+ * one row at a time, but all at once when the number is known. */
+
+static void
+trg_torrent_model_reserve(TrgTorrentModelPrivate * priv, guint slots)
+{
+    guint capacity = priv->capacity;
+    gint c;
+
+    if (slots <= capacity)
+        return;
+
+    while (capacity < slots)
+        capacity = MAX(64, capacity * 2);
+
+    for (c = 0; c < TORRENT_COLUMN_COLUMNS; c++)
+        priv->columns[c] = g_realloc(priv->columns[c],
+                                     capacity *
+                                     trg_torrent_model_column_size(c));
+    priv->positions = g_renew(guint, priv->positions, capacity);
+    priv->foldedNames = g_renew(gchar *, priv->foldedNames, capacity);
+    priv->nameMatches = g_renew(gboolean, priv->nameMatches, capacity);
+    for (c = 0; c < TORRENT_COLUMN_COLUMNS; c++)
+        if (trg_torrent_model_column_keyed(c))
+            priv->collateKeys[c] = g_renew(gchar *, priv->collateKeys[c],
+                                           capacity);
+
+    priv->capacity = capacity;
+}
+
+static guint trg_torrent_model_alloc_slot(TrgTorrentModelPrivate * priv)
+{
+    guint slot;
+    gint c;
+
+    if (priv->freeSlots->len > 0) {
+        slot = g_array_index(priv->freeSlots, guint,
+                             priv->freeSlots->len - 1);
+        g_array_set_size(priv->freeSlots, priv->freeSlots->len - 1);
+    } else {
+        trg_torrent_model_reserve(priv, priv->slots + 1);
+        slot = priv->slots++;
+    }
+
+    for (c = 0; c < TORRENT_COLUMN_COLUMNS; c++) {
+        gsize size = trg_torrent_model_column_size(c);
+        memset((guchar *) priv->columns[c] + slot * size, 0, size);
+        if (priv->collateKeys[c])
+            priv->collateKeys[c][slot] = NULL;
+    }
+
+    priv->foldedNames[slot] = NULL;
+    priv->nameMatches[slot] = priv->nameFilter == NULL;
+
+    return slot;
+}
+
+/* Add an empty row to the end. Nothing is told about it until
+ * trg_torrent_model_row_inserted(), so it can be filled in first.
+ */
+
+static void
+trg_torrent_model_append(TrgTorrentModel * model, GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint slot = trg_torrent_model_alloc_slot(priv);
+
+    priv->positions[slot] = priv->order->len;
+    g_array_append_val(priv->order, slot);
+
+    trg_torrent_model_set_iter(priv, iter, slot);
+}
+
+static void
+trg_torrent_model_row_inserted(TrgTorrentModel * model, GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    GtkTreePath *path =
+        gtk_tree_path_new_from_indices(trg_torrent_model_position
+                                       (priv, ITER_SLOT(iter)), -1);
+
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, iter);
+    gtk_tree_path_free(path);
+}
+
+/* Add (delta 1) or take away (delta -1) a row's rates from the speed
+ * totals. A row that hasn't been filled yet has none.
+ */
+
+static void
+trg_torrent_model_rates_account(TrgTorrentModelPrivate * priv, guint slot,
+                                gint delta)
+{
+    priv->stats.downRateTotal +=
+        delta * COLUMN_DATA(priv, gint64, TORRENT_COLUMN_DOWNSPEED)[slot];
+    priv->stats.upRateTotal +=
+        delta * COLUMN_DATA(priv, gint64, TORRENT_COLUMN_UPSPEED)[slot];
+}
+
+/* Add (delta 1) or take away (delta -1) a row with these flags from the
+ * state counts.
+ */
+
+static void
+trg_torrent_model_stats_account(trg_torrent_model_update_stats * stats,
+                                guint flags, gint delta)
+{
+    if (flags & TORRENT_FLAG_SEEDING)
+        stats->seeding += delta;
+    else if (flags & TORRENT_FLAG_DOWNLOADING)
+        stats->down += delta;
+    else if (flags & TORRENT_FLAG_PAUSED)
+        stats->paused += delta;
+
+    if (flags & TORRENT_FLAG_ERROR)
+        stats->error += delta;
+
+    if (flags & TORRENT_FLAG_COMPLETE)
+        stats->complete += delta;
+    else
+        stats->incomplete += delta;
+
+    if (flags & TORRENT_FLAG_CHECKING)
+        stats->checking += delta;
+
+    if (flags & TORRENT_FLAG_ACTIVE)
+        stats->active += delta;
+
+    if (flags & TORRENT_FLAG_SEEDING_WAIT)
+        stats->seed_wait += delta;
+
+    if (flags & TORRENT_FLAG_DOWNLOADING_WAIT)
+        stats->down_wait += delta;
+
+    stats->count += delta;
+}
+
+/* Count one more (delta 1) or one less (delta -1) torrent with name, and
+ * note that its count changed. Names are interned.
+ */
+
+static void
+trg_torrent_model_facet_add(TrgTorrentModelPrivate * priv, gint facet,
+                            const gchar * name, gint delta)
+{
+    gint count;
+
+    if (!name)
+        return;
+
+    count = GPOINTER_TO_INT(g_hash_table_lookup(priv->facets[facet], name))
+        + delta;
+
+    if (count > 0)
+        g_hash_table_insert(priv->facets[facet], (gpointer) name,
+                            GINT_TO_POINTER(count));
+    else
+        g_hash_table_remove(priv->facets[facet], name);
+
+    g_hash_table_add(priv->facetChanges[facet], (gpointer) name);
+}
+
+static void
+trg_torrent_model_facet_add_hosts(TrgTorrentModelPrivate * priv,
+                                  const gchar ** hosts, gint delta)
+{
+    for (; hosts && *hosts; hosts++)
+        trg_torrent_model_facet_add(priv, TORRENT_FACET_TRACKER, *hosts,
+                                    delta);
+}
+
+static void
+trg_torrent_model_facet_changes_clear(TrgTorrentModelPrivate * priv)
+{
+    gint i;
+
+    for (i = 0; i < TORRENT_FACET_COUNT; i++)
+        g_hash_table_remove_all(priv->facetChanges[i]);
+}
+
+/* Take a row out, dropping its JSON (if it has the detail) and strings. */
+
+static void trg_torrent_model_remove_slot(TrgTorrentModel * model,
+                                          guint slot)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint pos = trg_torrent_model_position(priv, slot);
+    JsonObject *json = COLUMN_DATA(priv, JsonObject *,
+                                   TORRENT_COLUMN_JSON)[slot];
+    GtkTreePath *path;
+    gint c;
+
+    if (json)
+        json_object_unref(json);
+
+    trg_torrent_model_rates_account(priv, slot, -1);
+    trg_torrent_model_stats_account(&priv->stats,
+                                    COLUMN_DATA(priv, gint,
+                                                TORRENT_COLUMN_FLAGS)[slot],
+                                    -1);
+    trg_torrent_model_facet_add(priv, TORRENT_FACET_DIR,
+                                COLUMN_DATA(priv, const gchar *,
+                                            TORRENT_COLUMN_DOWNLOADDIR_SHORT)
+                                [slot], -1);
+    trg_torrent_model_facet_add_hosts(priv,
+                                      COLUMN_DATA(priv, const gchar **,
+                                                  TORRENT_COLUMN_TRACKER_HOSTS)
+                                      [slot], -1);
+
+    g_free(COLUMN_DATA(priv, gpointer, TORRENT_COLUMN_TRACKER_HOSTS)[slot]);
+    g_free(priv->foldedNames[slot]);
+
+    for (c = 0; c < TORRENT_COLUMN_COLUMNS; c++) {
+        if (trg_torrent_model_column_keyed(c)) {
+            g_free(COLUMN_DATA(priv, gchar *, c)[slot]);
+            g_free(priv->collateKeys[c][slot]);
+        }
+    }
+
+    g_array_remove_index(priv->order, pos);
+    g_array_append_val(priv->freeSlots, slot);
+    priv->dirtyFrom = MIN(priv->dirtyFrom, pos);
+
+    path = gtk_tree_path_new_from_indices(pos, -1);
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+    gtk_tree_path_free(path);
+}
+
+/* Put a value into a row, returning whether that changed anything. */
+
+static gboolean
+trg_torrent_model_store_value(TrgTorrentModelPrivate * priv, guint slot,
+                              gint column, const GValue * value)
+{
+    switch (column_types[column]) {
+    case G_TYPE_INT64:{
+            gint64 *v = &COLUMN_DATA(priv, gint64, column)[slot];
+            gint64 n = g_value_get_int64(value);
+            if (*v == n)
+                return FALSE;
+            *v = n;
+            return TRUE;
+        }
+    case G_TYPE_DOUBLE:{
+            gdouble *v = &COLUMN_DATA(priv, gdouble, column)[slot];
+            gdouble n = g_value_get_double(value);
+            if (*v == n)
+                return FALSE;
+            *v = n;
+            return TRUE;
+        }
+    case G_TYPE_INT:{
+            gint *v = &COLUMN_DATA(priv, gint, column)[slot];
+            gint n = g_value_get_int(value);
+            if (*v == n)
+                return FALSE;
+            *v = n;
+            return TRUE;
+        }
+    case G_TYPE_UINT:{
+            guint *v = &COLUMN_DATA(priv, guint, column)[slot];
+            guint n = g_value_get_uint(value);
+            if (*v == n)
+                return FALSE;
+            *v = n;
+            return TRUE;
+        }
+    case G_TYPE_STRING:{
+            gchar **v = &COLUMN_DATA(priv, gchar *, column)[slot];
+            const gchar *n = g_value_get_string(value);
+            if (!g_strcmp0(*v, n))
+                return FALSE;
+            if (trg_torrent_model_column_interned(column)) {
+                *v = (gchar *) g_intern_string(n);
+            } else {
+                g_free(*v);
+                *v = g_strdup(n);
+                g_free(priv->collateKeys[column][slot]);
+                priv->collateKeys[column][slot] = NULL;
+            }
+            return TRUE;
+        }
+    default:{
+            gpointer *v = &COLUMN_DATA(priv, gpointer, column)[slot];
+            gpointer n = g_value_get_pointer(value);
+            if (*v == n)
+                return FALSE;
+            *v = n;
+            return TRUE;
+        }
+    }
+}
+
+static void trg_torrent_model_finalize(GObject * object)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(object);
+    guint i;
+    gint c;
+
+    for (i = 0; i < priv->order->len; i++) {
+        guint slot = g_array_index(priv->order, guint, i);
+        JsonObject *json = COLUMN_DATA(priv, JsonObject *,
+                                       TORRENT_COLUMN_JSON)[slot];
+
+        if (json)
+            json_object_unref(json);
+
+        g_free(COLUMN_DATA(priv, gpointer,
+                           TORRENT_COLUMN_TRACKER_HOSTS)[slot]);
+        g_free(priv->foldedNames[slot]);
+
+        for (c = 0; c < TORRENT_COLUMN_COLUMNS; c++) {
+            if (trg_torrent_model_column_keyed(c)) {
+                g_free(COLUMN_DATA(priv, gchar *, c)[slot]);
+                g_free(priv->collateKeys[c][slot]);
+            }
+        }
+    }
+
+    for (c = 0; c < TORRENT_COLUMN_COLUMNS; c++) {
+        g_free(priv->columns[c]);
+        g_free(priv->collateKeys[c]);
+    }
+
+    g_hash_table_destroy(priv->internedKeys);
+    g_hash_table_destroy(priv->shortDirs);
+
+    g_free(priv->positions);
+    g_free(priv->foldedNames);
+    g_free(priv->nameMatches);
+    g_free(priv->nameFilter);
+    g_array_free(priv->order, TRUE);
+    g_array_free(priv->freeSlots, TRUE);
+
+    for (c = 0; c < TORRENT_FACET_COUNT; c++) {
+        g_hash_table_destroy(priv->facets[c]);
+        g_hash_table_destroy(priv->facetChanges[c]);
+    }
+
+    G_OBJECT_CLASS(trg_torrent_model_parent_class)->finalize(object);
+}
+
 static void trg_torrent_model_dispose(GObject * object)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(object);
-    g_hash_table_destroy(priv->ht);
+    if (priv->ht) {
+        g_hash_table_destroy(priv->ht);
+        priv->ht = NULL;
+    }
+    if (priv->shadow) {
+        trg_torrents_shadow_free(priv->shadow);
+        priv->shadow = NULL;
+    }
     G_OBJECT_CLASS(trg_torrent_model_parent_class)->dispose(object);
 }
 
+/* GtkTreeModel */
+
+static GtkTreeModelFlags
+trg_torrent_model_tree_get_flags(GtkTreeModel * tree_model G_GNUC_UNUSED)
+{
+    return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+trg_torrent_model_tree_get_n_columns(GtkTreeModel * tree_model
+                                     G_GNUC_UNUSED)
+{
+    return TORRENT_COLUMN_COLUMNS;
+}
+
+static GType
+trg_torrent_model_tree_get_column_type(GtkTreeModel *
+                                       tree_model G_GNUC_UNUSED,
+                                       gint index)
+{
+    g_return_val_if_fail(index >= 0 && index < TORRENT_COLUMN_COLUMNS,
+                         G_TYPE_INVALID);
+    return column_types[index];
+}
+
+static gboolean
+trg_torrent_model_tree_get_iter(GtkTreeModel * tree_model,
+                                GtkTreeIter * iter, GtkTreePath * path)
+{
+    TrgTorrentModelPrivate *priv =
+        TRG_TORRENT_MODEL_GET_PRIVATE(tree_model);
+    gint i;
+
+    if (gtk_tree_path_get_depth(path) != 1)
+        return FALSE;
+
+    i = gtk_tree_path_get_indices(path)[0];
+    if (i < 0 || (guint) i >= priv->order->len)
+        return FALSE;
+
+    trg_torrent_model_set_iter(priv, iter,
+                               g_array_index(priv->order, guint, i));
+    return TRUE;
+}
+
+static GtkTreePath *trg_torrent_model_tree_get_path(GtkTreeModel *
+                                                    tree_model,
+                                                    GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv =
+        TRG_TORRENT_MODEL_GET_PRIVATE(tree_model);
+
+    g_return_val_if_fail(iter->stamp == priv->stamp, NULL);
+
+    return gtk_tree_path_new_from_indices(trg_torrent_model_position
+                                          (priv, ITER_SLOT(iter)), -1);
+}
+
+static void
+trg_torrent_model_tree_get_value(GtkTreeModel * tree_model,
+                                 GtkTreeIter * iter, gint column,
+                                 GValue * value)
+{
+    TrgTorrentModelPrivate *priv =
+        TRG_TORRENT_MODEL_GET_PRIVATE(tree_model);
+    guint slot = ITER_SLOT(iter);
+
+    g_return_if_fail(iter->stamp == priv->stamp);
+    g_return_if_fail(column >= 0 && column < TORRENT_COLUMN_COLUMNS);
+
+    g_value_init(value, column_types[column]);
+
+    switch (column_types[column]) {
+    case G_TYPE_INT64:
+        g_value_set_int64(value, COLUMN_DATA(priv, gint64, column)[slot]);
+        break;
+    case G_TYPE_DOUBLE:
+        g_value_set_double(value,
+                           COLUMN_DATA(priv, gdouble, column)[slot]);
+        break;
+    case G_TYPE_INT:
+        g_value_set_int(value, COLUMN_DATA(priv, gint, column)[slot]);
+        break;
+    case G_TYPE_UINT:
+        g_value_set_uint(value, COLUMN_DATA(priv, guint, column)[slot]);
+        break;
+    case G_TYPE_STRING:
+        g_value_set_string(value,
+                           COLUMN_DATA(priv, gchar *, column)[slot]);
+        break;
+    default:
+        g_value_set_pointer(value,
+                            COLUMN_DATA(priv, gpointer, column)[slot]);
+        break;
+    }
+}
+
+static gboolean trg_torrent_model_tree_iter_next(GtkTreeModel *
+                                                 tree_model,
+                                                 GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv =
+        TRG_TORRENT_MODEL_GET_PRIVATE(tree_model);
+    guint pos;
+
+    g_return_val_if_fail(iter->stamp == priv->stamp, FALSE);
+
+    pos = trg_torrent_model_position(priv, ITER_SLOT(iter)) + 1;
+    if (pos >= priv->order->len) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_torrent_model_set_iter(priv, iter,
+                               g_array_index(priv->order, guint, pos));
+    return TRUE;
+}
+
+static gboolean trg_torrent_model_tree_iter_previous(GtkTreeModel *
+                                                     tree_model,
+                                                     GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv =
+        TRG_TORRENT_MODEL_GET_PRIVATE(tree_model);
+    guint pos;
+
+    g_return_val_if_fail(iter->stamp == priv->stamp, FALSE);
+
+    pos = trg_torrent_model_position(priv, ITER_SLOT(iter));
+    if (pos == 0) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_torrent_model_set_iter(priv, iter,
+                               g_array_index(priv->order, guint, pos - 1));
+    return TRUE;
+}
+
+static gboolean
+trg_torrent_model_tree_iter_nth_child(GtkTreeModel * tree_model,
+                                      GtkTreeIter * iter,
+                                      GtkTreeIter * parent, gint n)
+{
+    TrgTorrentModelPrivate *priv =
+        TRG_TORRENT_MODEL_GET_PRIVATE(tree_model);
+
+    if (parent || n < 0 || (guint) n >= priv->order->len) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_torrent_model_set_iter(priv, iter,
+                               g_array_index(priv->order, guint, n));
+    return TRUE;
+}
+
+static gboolean
+trg_torrent_model_tree_iter_children(GtkTreeModel * tree_model,
+                                     GtkTreeIter * iter,
+                                     GtkTreeIter * parent)
+{
+    return trg_torrent_model_tree_iter_nth_child(tree_model, iter, parent,
+                                                 0);
+}
+
+static gboolean
+trg_torrent_model_tree_iter_has_child(GtkTreeModel *
+                                      tree_model G_GNUC_UNUSED,
+                                      GtkTreeIter * iter G_GNUC_UNUSED)
+{
+    return FALSE;
+}
+
+static gint
+trg_torrent_model_tree_iter_n_children(GtkTreeModel * tree_model,
+                                       GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv =
+        TRG_TORRENT_MODEL_GET_PRIVATE(tree_model);
+
+    return iter ? 0 : (gint) priv->order->len;
+}
+
+static gboolean
+trg_torrent_model_tree_iter_parent(GtkTreeModel *
+                                   tree_model G_GNUC_UNUSED,
+                                   GtkTreeIter * iter,
+                                   GtkTreeIter * child G_GNUC_UNUSED)
+{
+    iter->stamp = 0;
+    return FALSE;
+}
+
+static void trg_torrent_model_tree_model_init(GtkTreeModelIface * iface)
+{
+    iface->get_flags = trg_torrent_model_tree_get_flags;
+    iface->get_n_columns = trg_torrent_model_tree_get_n_columns;
+    iface->get_column_type = trg_torrent_model_tree_get_column_type;
+    iface->get_iter = trg_torrent_model_tree_get_iter;
+    iface->get_path = trg_torrent_model_tree_get_path;
+    iface->get_value = trg_torrent_model_tree_get_value;
+    iface->iter_next = trg_torrent_model_tree_iter_next;
+    iface->iter_previous = trg_torrent_model_tree_iter_previous;
+    iface->iter_children = trg_torrent_model_tree_iter_children;
+    iface->iter_has_child = trg_torrent_model_tree_iter_has_child;
+    iface->iter_n_children = trg_torrent_model_tree_iter_n_children;
+    iface->iter_nth_child = trg_torrent_model_tree_iter_nth_child;
+    iface->iter_parent = trg_torrent_model_tree_iter_parent;
+}
+
+/* Typed access to a row, without the GValue and string copies of
+ * gtk_tree_model_get(). Strings belong to the model. */
+
+gint trg_torrent_model_get_flags(TrgTorrentModel * model,
+                                 GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return COLUMN_DATA(priv, gint, TORRENT_COLUMN_FLAGS)[ITER_SLOT(iter)];
+}
+
+gint64 trg_torrent_model_get_int64(TrgTorrentModel * model,
+                                   GtkTreeIter * iter, gint column)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    g_return_val_if_fail(column_types[column] == G_TYPE_INT64, 0);
+    return COLUMN_DATA(priv, gint64, column)[ITER_SLOT(iter)];
+}
+
+gdouble trg_torrent_model_get_double(TrgTorrentModel * model,
+                                     GtkTreeIter * iter, gint column)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    g_return_val_if_fail(column_types[column] == G_TYPE_DOUBLE, 0);
+    return COLUMN_DATA(priv, gdouble, column)[ITER_SLOT(iter)];
+}
+
+const gchar *trg_torrent_model_peek_string(TrgTorrentModel * model,
+                                           GtkTreeIter * iter,
+                                           gint column)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    g_return_val_if_fail(column_types[column] == G_TYPE_STRING, NULL);
+    return COLUMN_DATA(priv, gchar *, column)[ITER_SLOT(iter)];
+}
+
+/* The torrent as a JSON object, only kept for the torrent the detail was
+ * last received for. NULL for any other. */
+
+JsonObject *trg_torrent_model_get_json(TrgTorrentModel * model,
+                                       GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return COLUMN_DATA(priv, JsonObject *,
+                       TORRENT_COLUMN_JSON)[ITER_SLOT(iter)];
+}
+
+/* The torrent's distinct announce hosts, interned and NULL terminated, or
+ * NULL if its trackers haven't been polled. */
+
+const gchar **trg_torrent_model_peek_tracker_hosts(TrgTorrentModel *
+                                                   model,
+                                                   GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return COLUMN_DATA(priv, const gchar **,
+                       TORRENT_COLUMN_TRACKER_HOSTS)[ITER_SLOT(iter)];
+}
+
+/* Whether any of the torrent's trackers announce to host, which must be
+ * interned. */
+
+gboolean trg_torrent_model_has_tracker_host(TrgTorrentModel * model,
+                                            GtkTreeIter * iter,
+                                            const gchar * host)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    const gchar **hosts = COLUMN_DATA(priv, const gchar **,
+                                      TORRENT_COLUMN_TRACKER_HOSTS)
+        [ITER_SLOT(iter)];
+
+    for (; host && hosts && *hosts; hosts++)
+        if (*hosts == host)
+            return TRUE;
+
+    return FALSE;
+}
+
+/* A string's collation key. Interned strings share one per value, owned
+ * strings keep one per row until the string changes. */
+
+static const gchar *trg_torrent_model_collate_key(TrgTorrentModelPrivate *
+                                                  priv, guint slot,
+                                                  gint column)
+{
+    const gchar *str = COLUMN_DATA(priv, gchar *, column)[slot];
+    gchar *key;
+
+    if (!str)
+        return NULL;
+
+    if (trg_torrent_model_column_interned(column)) {
+        key = g_hash_table_lookup(priv->internedKeys, str);
+        if (!key) {
+            key = g_utf8_collate_key(str, -1);
+            g_hash_table_insert(priv->internedKeys, (gpointer) str, key);
+        }
+    } else {
+        key = priv->collateKeys[column][slot];
+        if (!key) {
+            key = g_utf8_collate_key(str, -1);
+            priv->collateKeys[column][slot] = key;
+        }
+    }
+
+    return key;
+}
+
+/* Compare two rows by a column, reading the values where they are. */
+
+gint trg_torrent_model_compare(TrgTorrentModel * model, gint column,
+                               GtkTreeIter * a, GtkTreeIter * b)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint sa = ITER_SLOT(a);
+    guint sb = ITER_SLOT(b);
+
+    g_return_val_if_fail(column >= 0 && column < TORRENT_COLUMN_COLUMNS, 0);
+
+    switch (column_types[column]) {
+    case G_TYPE_INT64:{
+            gint64 va = COLUMN_DATA(priv, gint64, column)[sa];
+            gint64 vb = COLUMN_DATA(priv, gint64, column)[sb];
+            return va < vb ? -1 : va > vb;
+        }
+    case G_TYPE_DOUBLE:{
+            gdouble va = COLUMN_DATA(priv, gdouble, column)[sa];
+            gdouble vb = COLUMN_DATA(priv, gdouble, column)[sb];
+            return va < vb ? -1 : va > vb;
+        }
+    case G_TYPE_INT:{
+            gint va = COLUMN_DATA(priv, gint, column)[sa];
+            gint vb = COLUMN_DATA(priv, gint, column)[sb];
+            return va < vb ? -1 : va > vb;
+        }
+    case G_TYPE_UINT:{
+            guint va = COLUMN_DATA(priv, guint, column)[sa];
+            guint vb = COLUMN_DATA(priv, guint, column)[sb];
+            return va < vb ? -1 : va > vb;
+        }
+    case G_TYPE_STRING:{
+            const gchar *ka =
+                trg_torrent_model_collate_key(priv, sa, column);
+            const gchar *kb =
+                trg_torrent_model_collate_key(priv, sb, column);
+            if (!ka || !kb)
+                return ka ? 1 : kb ? -1 : 0;
+            return strcmp(ka, kb);
+        }
+    default:
+        return 0;
+    }
+}
+
+/* Normalize and casefold a name, or filter text, for searching. */
+
+gchar *trg_torrent_model_fold_name(const gchar * name)
+{
+    gchar *normalized = g_utf8_normalize(name, -1, G_NORMALIZE_ALL);
+    gchar *folded = g_utf8_casefold(normalized ? normalized : name, -1);
+
+    g_free(normalized);
+
+    return folded;
+}
+
+/* Set the text torrent names are filtered by, NULL or empty for none.
+ * Returns whether any row might have gone from matching to not or back,
+ * and so whether a refilter is needed. If the new text contains the old,
+ * only rows that matched before can still match, so only those are
+ * searched again.
+ */
+
+gboolean trg_torrent_model_set_name_filter(TrgTorrentModel * model,
+                                           const gchar * text)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    gchar *filter = text && *text ? trg_torrent_model_fold_name(text) :
+        NULL;
+    gboolean narrowing;
+    guint i;
+
+    if (!g_strcmp0(filter, priv->nameFilter)) {
+        g_free(filter);
+        return FALSE;
+    }
+
+    narrowing = priv->nameFilter && filter
+        && strstr(filter, priv->nameFilter);
+
+    for (i = 0; i < priv->order->len; i++) {
+        guint slot = g_array_index(priv->order, guint, i);
+
+        if (narrowing && !priv->nameMatches[slot])
+            continue;
+
+        priv->nameMatches[slot] = !filter || (priv->foldedNames[slot]
+                                              && strstr(priv->foldedNames
+                                                        [slot], filter));
+    }
+
+    g_free(priv->nameFilter);
+    priv->nameFilter = filter;
+
+    return TRUE;
+}
+
+/* The name normalized and casefolded, as the name filter searches it. */
+
+const gchar *trg_torrent_model_peek_folded_name(TrgTorrentModel * model,
+                                                GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return priv->foldedNames[ITER_SLOT(iter)];
+}
+
+gboolean trg_torrent_model_name_matches(TrgTorrentModel * model,
+                                        GtkTreeIter * iter)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return priv->nameMatches[ITER_SLOT(iter)];
+}
+
+/* Fold a row's new name and see if it matches the filter. */
+
+static void
+trg_torrent_model_index_name(TrgTorrentModelPrivate * priv, guint slot,
+                             const gchar * name)
+{
+    gchar *folded = name ? trg_torrent_model_fold_name(name) : NULL;
+
+    g_free(priv->foldedNames[slot]);
+    priv->foldedNames[slot] = folded;
+    priv->nameMatches[slot] = !priv->nameFilter
+        || (folded && strstr(folded, priv->nameFilter));
+}
+
 static void
-update_torrent_iter(TrgTorrentModel * model, TrgClient * tc, gint64 rpcv,
-                    gint64 serial, GtkTreeIter * iter, JsonObject * t,
-                    trg_torrent_model_update_stats * stats,
-                    guint * whatsChanged);
+update_torrent_iter(TrgTorrentModel * model, TrgClient * tc,
+                    GtkTreeIter * iter, const trg_torrent_record * r,
+                    gboolean isNew, guint * whatsChanged);
 
 static void trg_torrent_model_class_init(TrgTorrentModelClass * klass)
 {
@@ -96,6 +1073,7 @@ static void trg_torrent_model_class_init(TrgTorrentModelClass * klass)
 
     g_type_class_add_private(klass, sizeof(TrgTorrentModelPrivate));
     object_class->dispose = trg_torrent_model_dispose;
+    object_class->finalize = trg_torrent_model_finalize;
 
     signals[TMODEL_TORRENT_COMPLETED] = g_signal_new("torrent-completed",
                                                      G_TYPE_FROM_CLASS
@@ -156,120 +1134,201 @@ trg_torrent_model_update_stats *trg_torrent_model_get_stats(TrgTorrentModel
     return &(priv->stats);
 }
 
+/* The columns for one row, collected so they can all be set (and
+ * row-changed emitted) in one go. Columns for fields that weren't in the
+ * response aren't added, and keep whatever they had.
+ */
+
+typedef struct {
+    gint columns[TORRENT_COLUMN_COLUMNS];
+    GValue values[TORRENT_COLUMN_COLUMNS];
+    gint n;
+} trg_torrent_row;
+
+static GValue *trg_torrent_row_add(trg_torrent_row * row, gint column,
+                                   GType type)
+{
+    GValue *value = &row->values[row->n];
+
+    row->columns[row->n++] = column;
+    memset(value, 0, sizeof(GValue));
+
+    return g_value_init(value, type);
+}
+
 static void
-trg_torrent_model_count_peers(TrgTorrentModel * model,
-                              GtkTreeIter * iter, JsonObject * t)
+trg_torrent_row_set_int64(trg_torrent_row * row, gint column, gint64 v)
 {
-    GList *trackersList =
-        json_array_get_elements(torrent_get_tracker_stats(t));
-    gint64 seeders = 0;
-    gint64 leechers = 0;
-    gint64 downloads = 0;
-    GList *li;
+    g_value_set_int64(trg_torrent_row_add(row, column, G_TYPE_INT64), v);
+}
 
-    for (li = trackersList; li; li = g_list_next(li)) {
-        JsonObject *tracker = json_node_get_object((JsonNode *) li->data);
+static void
+trg_torrent_row_set_double(trg_torrent_row * row, gint column, gdouble v)
+{
+    g_value_set_double(trg_torrent_row_add(row, column, G_TYPE_DOUBLE), v);
+}
 
-        seeders += tracker_stats_get_seeder_count(tracker);
-        leechers += tracker_stats_get_leecher_count(tracker);
-        downloads += tracker_stats_get_download_count(tracker);
+/* The model takes its own copy, so v only needs to last until commit. */
+static void
+trg_torrent_row_set_string(trg_torrent_row * row, gint column,
+                           const gchar * v)
+{
+    g_value_set_static_string(trg_torrent_row_add
+                              (row, column, G_TYPE_STRING), v);
+}
+
+/* Store the row's columns, and emit row-changed if any of them differ.
+ * Every row-changed means a re-sort, re-filter and re-measure further up
+ * the chain, so a row where nothing shows a difference doesn't get one.
+ * A new row gets row-inserted from the caller instead.
+ */
+
+static void
+trg_torrent_row_commit(TrgTorrentModel * model, GtkTreeIter * iter,
+                       trg_torrent_row * row, gboolean isNew)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    gboolean changed = FALSE;
+    gint i;
+
+    for (i = 0; i < row->n; i++) {
+        changed |= trg_torrent_model_store_value(priv, ITER_SLOT(iter),
+                                                 row->columns[i],
+                                                 &row->values[i]);
+        g_value_unset(&row->values[i]);
     }
 
-    g_list_free(trackersList);
+    row->n = 0;
 
-    gtk_list_store_set(GTK_LIST_STORE(model), iter, TORRENT_COLUMN_SEEDS,
-                       seeders, TORRENT_COLUMN_LEECHERS, leechers,
-                       TORRENT_COLUMN_DOWNLOADS, downloads, -1);
+    if (changed && !isNew) {
+        GtkTreePath *path = gtk_tree_model_get_path(GTK_TREE_MODEL(model),
+                                                    iter);
+        gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, iter);
+        gtk_tree_path_free(path);
+    }
 }
 
-static void trg_torrent_model_ref_free(gpointer data)
+/* Move the detail to another torrent (or none, -1). The one before only
+ * had an object for it, so that goes, and the shadow is told so the worker
+ * threads only make an object for the new one. */
+
+static void
+trg_torrent_model_set_detail_id(TrgTorrentModel * model, gint64 id)
 {
-    GtkTreeRowReference *rr = (GtkTreeRowReference *) data;
-    GtkTreeModel *model = gtk_tree_row_reference_get_model(rr);
-    GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-    if (path) {
-        GtkTreeIter iter;
-        JsonObject *json;
-        if (gtk_tree_model_get_iter(model, &iter, path)) {
-            gtk_tree_model_get(model, &iter, TORRENT_COLUMN_JSON, &json,
-                               -1);
-            json_object_unref(json);
-            g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
-                              GINT_TO_POINTER(TRUE));
-            gtk_list_store_remove(GTK_LIST_STORE(model), &iter);
-            g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
-                              GINT_TO_POINTER(FALSE));
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    trg_torrent_table_entry *entry;
+
+    if (id == priv->detailId)
+        return;
+
+    entry = g_hash_table_lookup(priv->ht, &priv->detailId);
+    if (entry) {
+        JsonObject **json = &COLUMN_DATA(priv, JsonObject *,
+                                          TORRENT_COLUMN_JSON)
+            [ITER_SLOT(&entry->iter)];
+
+        if (*json) {
+            json_object_unref(*json);
+            *json = NULL;
         }
+    }
 
-        gtk_tree_path_free(path);
+    priv->detailId = id;
+    trg_torrents_shadow_set_detail_id(priv->shadow, id);
+}
+
+/* Highest position first, so removing one doesn't move the rest. */
+
+static gint
+trg_torrent_model_position_compare(gconstpointer a, gconstpointer b,
+                                   gpointer data)
+{
+    TrgTorrentModelPrivate *priv = (TrgTorrentModelPrivate *) data;
+    guint pa = priv->positions[*(const guint *) a];
+    guint pb = priv->positions[*(const guint *) b];
+
+    return pa < pb ? 1 : pa > pb ? -1 : 0;
+}
+
+/* Remove a batch of torrents by ID, in a single pass over the list with
+ * remove-in-progress set once around the lot. IDs we don't have are
+ * skipped. Returns how many rows went.
+ */
+
+static guint
+trg_torrent_model_remove_ids(TrgTorrentModel * model, GArray * ids)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    GArray *slots = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+                                      ids->len);
+    guint i;
+
+    for (i = 0; i < ids->len; i++) {
+        gint64 id = g_array_index(ids, gint64, i);
+        trg_torrent_table_entry *entry =
+            g_hash_table_lookup(priv->ht, &id);
+        guint slot;
+
+        if (!entry)
+            continue;
+
+        slot = ITER_SLOT(&entry->iter);
+        trg_torrent_model_position(priv, slot);
+        g_array_append_val(slots, slot);
+
+        g_hash_table_remove(priv->ht, &id);
+
+        if (id == priv->detailId)
+            trg_torrent_model_set_detail_id(model, -1);
     }
 
-    gtk_tree_row_reference_free(rr);
+    g_array_sort_with_data(slots, trg_torrent_model_position_compare,
+                           priv);
+
+    g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
+                      GINT_TO_POINTER(TRUE));
+
+    for (i = 0; i < slots->len; i++)
+        trg_torrent_model_remove_slot(model,
+                                      g_array_index(slots, guint, i));
+
+    g_object_set_data(G_OBJECT(model), PROP_REMOVE_IN_PROGRESS,
+                      GINT_TO_POINTER(FALSE));
+
+    i = slots->len;
+    g_array_free(slots, TRUE);
+
+    return i;
 }
 
 static void trg_torrent_model_init(TrgTorrentModel * self)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(self);
+    gint i;
+
+    priv->stamp = g_random_int();
+    priv->order = g_array_new(FALSE, FALSE, sizeof(guint));
+    priv->freeSlots = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    for (i = 0; i < TORRENT_FACET_COUNT; i++) {
+        priv->facets[i] = g_hash_table_new(g_direct_hash, g_direct_equal);
+        priv->facetChanges[i] =
+            g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+    priv->dirtyFrom = G_MAXUINT;
+    priv->internedKeys = g_hash_table_new_full(g_direct_hash,
+                                               g_direct_equal, NULL,
+                                               g_free);
+    priv->shortDirs = g_hash_table_new(g_direct_hash, g_direct_equal);
 
-    GType column_types[TORRENT_COLUMN_COLUMNS];
-
-    column_types[TORRENT_COLUMN_ICON] = G_TYPE_STRING;
-    column_types[TORRENT_COLUMN_NAME] = G_TYPE_STRING;
-    column_types[TORRENT_COLUMN_ERROR] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_SIZEWHENDONE] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_TOTALSIZE] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_HAVE_UNCHECKED] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_PERCENTDONE] = G_TYPE_DOUBLE;
-    column_types[TORRENT_COLUMN_METADATAPERCENTCOMPLETE] = G_TYPE_DOUBLE;
-    column_types[TORRENT_COLUMN_STATUS] = G_TYPE_STRING;
-    column_types[TORRENT_COLUMN_SEEDS] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_LEECHERS] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_DOWNLOADS] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_DOWNSPEED] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_ADDED] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_UPSPEED] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_ETA] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_UPLOADED] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_DOWNLOADED] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_HAVE_VALID] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_RATIO] = G_TYPE_DOUBLE;
-    column_types[TORRENT_COLUMN_ID] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_JSON] = G_TYPE_POINTER;
-    column_types[TORRENT_COLUMN_UPDATESERIAL] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FLAGS] = G_TYPE_INT;
-    column_types[TORRENT_COLUMN_DOWNLOADDIR] = G_TYPE_STRING;
-    column_types[TORRENT_COLUMN_DOWNLOADDIR_SHORT] = G_TYPE_STRING;
-    column_types[TORRENT_COLUMN_BANDWIDTH_PRIORITY] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_DONE_DATE] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FROMPEX] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FROMDHT] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FROMTRACKERS] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FROMLTEP] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FROMRESUME] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FROMINCOMING] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_PEER_SOURCES] = G_TYPE_STRING;
-    column_types[TORRENT_COLUMN_SEED_RATIO_LIMIT] = G_TYPE_DOUBLE;
-    column_types[TORRENT_COLUMN_SEED_RATIO_MODE] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_PEERS_CONNECTED] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_PEERS_FROM_US] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_WEB_SEEDS_TO_US] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_PEERS_TO_US] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_TRACKERHOST] = G_TYPE_STRING;
-    column_types[TORRENT_COLUMN_QUEUE_POSITION] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_LASTACTIVE] = G_TYPE_INT64;
-    column_types[TORRENT_COLUMN_FILECOUNT] = G_TYPE_UINT;
-
-    gtk_list_store_set_column_types(GTK_LIST_STORE(self),
-                                    TORRENT_COLUMN_COLUMNS, column_types);
-
-    priv->ht = g_hash_table_new_full(g_int64_hash, g_int64_equal,
-                                     (GDestroyNotify) g_free,
-                                     trg_torrent_model_ref_free);
+    priv->ht = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL,
+                                     g_free);
+    priv->shadow = trg_torrents_shadow_new();
 
     g_object_set_data(G_OBJECT(self), PROP_REMOVE_IN_PROGRESS,
                       GINT_TO_POINTER(FALSE));
 
-    priv->urlHostRegex = trg_uri_host_regex_new();
+    priv->detailId = -1;
 }
 
 gboolean trg_torrent_model_is_remove_in_progress(TrgTorrentModel * model)
@@ -279,93 +1338,125 @@ gboolean trg_torrent_model_is_remove_in_progress(TrgTorrentModel * model)
                                        PROP_REMOVE_IN_PROGRESS));
 }
 
-static gboolean
-trg_torrent_model_reload_dir_aliases_foreachfunc(GtkTreeModel * model,
-                                                 GtkTreePath *
-                                                 path G_GNUC_UNUSED,
-                                                 GtkTreeIter * iter,
-                                                 gpointer gdata)
-{
-    gchar *downloadDir, *shortDownloadDir;
-
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_DOWNLOADDIR,
-                       &downloadDir, -1);
-
-    shortDownloadDir =
-        shorten_download_dir((TrgClient *) gdata, downloadDir);
-
-    gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                       TORRENT_COLUMN_DOWNLOADDIR_SHORT, shortDownloadDir,
-                       -1);
+/* The short version of a download directory, interned. Worked out once
+ * per directory, not once per torrent in it, until the aliases or the
+ * default directory change.
+ */
 
-    g_free(downloadDir);
-    g_free(shortDownloadDir);
+static const gchar *trg_torrent_model_short_dir(TrgTorrentModel * model,
+                                                TrgClient * tc,
+                                                const gchar * downloadDir)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    const gchar *dir = g_intern_string(downloadDir);
+    const gchar *shortDir = g_hash_table_lookup(priv->shortDirs, dir);
+
+    if (!shortDir) {
+        gchar *shortened = shorten_download_dir(tc, dir);
+        shortDir = g_intern_string(shortened);
+        g_free(shortened);
+        g_hash_table_insert(priv->shortDirs, (gpointer) dir,
+                            (gpointer) shortDir);
+    }
 
-    return FALSE;
+    return shortDir;
 }
 
 void
 trg_torrent_model_reload_dir_aliases(TrgClient * tc, GtkTreeModel * model)
 {
-    gtk_tree_model_foreach(model,
-                           trg_torrent_model_reload_dir_aliases_foreachfunc,
-                           tc);
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    trg_torrent_row row;
+    GtkTreeIter iter;
+    guint i;
+
+    row.n = 0;
+    trg_torrent_model_facet_changes_clear(priv);
+    g_hash_table_remove_all(priv->shortDirs);
+
+    for (i = 0; i < priv->order->len; i++) {
+        const gchar *lastShortDir;
+        const gchar *shortDownloadDir;
+
+        trg_torrent_model_set_iter(priv, &iter,
+                                   g_array_index(priv->order, guint, i));
+        lastShortDir =
+            trg_torrent_model_peek_string(TRG_TORRENT_MODEL(model), &iter,
+                                          TORRENT_COLUMN_DOWNLOADDIR_SHORT);
+        shortDownloadDir =
+            trg_torrent_model_short_dir(TRG_TORRENT_MODEL(model), tc,
+                                        trg_torrent_model_peek_string
+                                        (TRG_TORRENT_MODEL(model), &iter,
+                                         TORRENT_COLUMN_DOWNLOADDIR));
+
+        if (g_strcmp0(lastShortDir, shortDownloadDir)) {
+            trg_torrent_model_facet_add(priv, TORRENT_FACET_DIR,
+                                        lastShortDir, -1);
+            trg_torrent_model_facet_add(priv, TORRENT_FACET_DIR,
+                                        shortDownloadDir, 1);
+            trg_torrent_row_set_string(&row,
+                                       TORRENT_COLUMN_DOWNLOADDIR_SHORT,
+                                       shortDownloadDir);
+            trg_torrent_row_commit(TRG_TORRENT_MODEL(model), &iter, &row,
+                                   FALSE);
+        }
+    }
+
     g_signal_emit(model, signals[TMODEL_STATE_CHANGED], 0,
                   TORRENT_UPDATE_PATH_CHANGE);
 }
 
-static gboolean
-trg_torrent_model_stats_scan_foreachfunc(GtkTreeModel *
-                                         model,
-                                         GtkTreePath *
-                                         path
-                                         G_GNUC_UNUSED,
-                                         GtkTreeIter * iter,
-                                         gpointer gdata)
-{
-    trg_torrent_model_update_stats *stats =
-        (trg_torrent_model_update_stats *) gdata;
-    guint flags;
-
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_FLAGS, &flags, -1);
-
-    if (flags & TORRENT_FLAG_SEEDING)
-        stats->seeding++;
-    else if (flags & TORRENT_FLAG_DOWNLOADING)
-        stats->down++;
-    else if (flags & TORRENT_FLAG_PAUSED)
-        stats->paused++;
-
-    if (flags & TORRENT_FLAG_ERROR)
-        stats->error++;
-
-    if (flags & TORRENT_FLAG_COMPLETE)
-        stats->complete++;
-    else
-        stats->incomplete++;
-
-    if (flags & TORRENT_FLAG_CHECKING)
-        stats->checking++;
+#ifdef DEBUG
+/* Count states and speeds straight off the flags and rate columns, to
+ * check the totals kept as rows change against. Set TRG_CHECK_STATS to
+ * have every update do it.
+ */
 
-    if (flags & TORRENT_FLAG_ACTIVE)
-        stats->active++;
+static void
+trg_torrent_model_stats_check(TrgTorrentModelPrivate * priv)
+{
+    trg_torrent_model_update_stats scanned;
+    const gint *flagsColumn = COLUMN_DATA(priv, gint, TORRENT_COLUMN_FLAGS);
+    guint i;
 
-    if (flags & TORRENT_FLAG_SEEDING_WAIT)
-        stats->seed_wait++;
+    memset(&scanned, 0, sizeof(scanned));
 
-    if (flags & TORRENT_FLAG_DOWNLOADING_WAIT)
-        stats->down_wait++;
+    for (i = 0; i < priv->order->len; i++) {
+        guint slot = g_array_index(priv->order, guint, i);
 
-    stats->count++;
+        trg_torrent_model_stats_account(&scanned, flagsColumn[slot], 1);
+        scanned.downRateTotal +=
+            COLUMN_DATA(priv, gint64, TORRENT_COLUMN_DOWNSPEED)[slot];
+        scanned.upRateTotal +=
+            COLUMN_DATA(priv, gint64, TORRENT_COLUMN_UPSPEED)[slot];
+    }
 
-    return FALSE;
+    if (memcmp(&scanned, &priv->stats, sizeof(scanned))) {
+        g_warning("torrent state counts out of step, %d rows counted as %d",
+                  scanned.count, priv->stats.count);
+        priv->stats = scanned;
+    }
 }
+#endif
 
 void trg_torrent_model_remove_all(TrgTorrentModel * model)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+
     g_hash_table_remove_all(priv->ht);
-    gtk_list_store_clear(GTK_LIST_STORE(model));
+    g_hash_table_remove_all(priv->shortDirs);
+
+    while (priv->order->len > 0)
+        trg_torrent_model_remove_slot(model,
+                                      g_array_index(priv->order, guint,
+                                                    priv->order->len -
+                                                    1));
+
+    g_array_set_size(priv->freeSlots, 0);
+    priv->slots = 0;
+    priv->dirtyFrom = G_MAXUINT;
+    priv->stamp++;
+    trg_torrent_model_set_detail_id(model, -1);
 }
 
 gchar *shorten_download_dir(TrgClient * tc, const gchar * downloadDir)
@@ -419,219 +1510,352 @@ gchar *shorten_download_dir(TrgClient * tc, const gchar * downloadDir)
     return g_strdup(downloadDir);
 }
 
+/* List polls don't include the detail fields, so carry them over from the
+ * previous object for the torrent whose detail we last received, the only
+ * one list polls make an object for. Members are copied into t.
+ */
+
+static void
+trg_torrent_model_keep_detail(TrgTorrentModel * model, gint64 id,
+                              JsonObject * t, JsonObject * lastJson)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    GList *members, *li;
+
+    if (torrent_has_detail(t)) {
+        trg_torrent_model_set_detail_id(model, id);
+        return;
+    }
+
+    if (id != priv->detailId || !torrent_has_detail(lastJson))
+        return;
+
+    members = json_object_get_members(lastJson);
+    for (li = members; li; li = g_list_next(li)) {
+        const gchar *member = (const gchar *) li->data;
+        if (!json_object_has_member(t, member))
+            json_object_set_member(t, member,
+                                   json_node_copy(json_object_get_member
+                                                  (lastJson, member)));
+    }
+    g_list_free(members);
+}
+
+/* The torrent-get fields a column is worked out from, so the list poll
+ * can leave out what isn't being shown. Columns not listed only use core
+ * fields, which are always polled.
+ */
+
+guint64 trg_torrent_model_column_fields(gint column)
+{
+    switch (column) {
+    case TORRENT_COLUMN_SIZEWHENDONE:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_SIZEWHENDONE);
+    case TORRENT_COLUMN_METADATAPERCENTCOMPLETE:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_METADATAPERCENTCOMPLETE);
+    case TORRENT_COLUMN_SEEDS:
+    case TORRENT_COLUMN_LEECHERS:
+    case TORRENT_COLUMN_DOWNLOADS:
+    case TORRENT_COLUMN_TRACKERHOST:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_TRACKER_STATS);
+    case TORRENT_COLUMN_PEERS_CONNECTED:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_PEERS_CONNECTED);
+    case TORRENT_COLUMN_WEB_SEEDS_TO_US:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_WEB_SEEDS_SENDING_TO_US);
+    case TORRENT_COLUMN_PEERS_TO_US:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_PEERS_SENDING_TO_US);
+    case TORRENT_COLUMN_ETA:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_ETA);
+    case TORRENT_COLUMN_UPLOADED:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_UPLOADEDEVER);
+    case TORRENT_COLUMN_DOWNLOADED:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_DOWNLOADEDEVER);
+    case TORRENT_COLUMN_TOTALSIZE:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_TOTAL_SIZE);
+    case TORRENT_COLUMN_HAVE_UNCHECKED:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_HAVEUNCHECKED);
+    case TORRENT_COLUMN_HAVE_VALID:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_HAVEVALID);
+    case TORRENT_COLUMN_RATIO:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_UPLOADEDEVER) |
+            TORRENT_FIELD_BIT(TORRENT_FIELD_HAVEVALID);
+    case TORRENT_COLUMN_ADDED:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_ADDED_DATE);
+    case TORRENT_COLUMN_DONE_DATE:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_DONE_DATE);
+    case TORRENT_COLUMN_FROMPEX:
+    case TORRENT_COLUMN_FROMDHT:
+    case TORRENT_COLUMN_FROMTRACKERS:
+    case TORRENT_COLUMN_FROMLTEP:
+    case TORRENT_COLUMN_FROMRESUME:
+    case TORRENT_COLUMN_FROMINCOMING:
+    case TORRENT_COLUMN_PEER_SOURCES:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_PEERSFROM);
+    case TORRENT_COLUMN_SEED_RATIO_LIMIT:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_SEED_RATIO_LIMIT);
+    case TORRENT_COLUMN_SEED_RATIO_MODE:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_SEED_RATIO_MODE);
+    case TORRENT_COLUMN_QUEUE_POSITION:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_QUEUE_POSITION);
+    case TORRENT_COLUMN_LASTACTIVE:
+        return TORRENT_FIELD_BIT(TORRENT_FIELD_ACTIVITY_DATE);
+    default:
+        return 0;
+    }
+}
+
+static gchar *trg_torrent_model_peer_sources(const trg_torrent_record * r)
+{
+    if (r->fromLpd >= 0)
+        return g_strdup_printf("%" G_GINT64_FORMAT " / %" G_GINT64_FORMAT
+                               " / %" G_GINT64_FORMAT " / %"
+                               G_GINT64_FORMAT " / %" G_GINT64_FORMAT
+                               " / %" G_GINT64_FORMAT " / %"
+                               G_GINT64_FORMAT, r->fromTrackers,
+                               r->fromIncoming, r->fromLtep, r->fromDht,
+                               r->fromPex, r->fromLpd, r->fromResume);
+    else
+        return g_strdup_printf("%" G_GINT64_FORMAT " / %" G_GINT64_FORMAT
+                               " / %" G_GINT64_FORMAT " / %"
+                               G_GINT64_FORMAT " / %" G_GINT64_FORMAT
+                               " / N/A / %" G_GINT64_FORMAT,
+                               r->fromTrackers, r->fromIncoming,
+                               r->fromLtep, r->fromDht, r->fromPex,
+                               r->fromResume);
+}
+
+static gboolean
+trg_torrent_model_hosts_equal(const gchar ** a, const gchar ** b)
+{
+    if (!a || !b)
+        return a == b;
+
+    for (; *a && *a == *b; a++, b++);
+
+    return *a == *b;
+}
+
 static inline void
 update_torrent_iter(TrgTorrentModel * model,
-                    TrgClient * tc, gint64 rpcv,
-                    gint64 serial, GtkTreeIter * iter,
-                    JsonObject * t,
-                    trg_torrent_model_update_stats *
-                    stats, guint * whatsChanged)
+                    TrgClient * tc,
+                    GtkTreeIter * iter,
+                    const trg_torrent_record * r, gboolean isNew,
+                    guint * whatsChanged)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
-    GtkListStore *ls = GTK_LIST_STORE(model);
+    trg_torrent_row row;
     guint lastFlags, newFlags;
-    JsonObject *lastJson, *pf;
-    JsonArray *trackerStats;
-    gchar *statusString, *statusIcon, *downloadDir;
-    gint64 downRate, upRate, haveValid, uploaded, downloaded, id, status,
-        lpd;
-    guint fileCount;
-    gchar *firstTrackerHost = NULL;
+    JsonObject *lastJson, *newJson;
+    const gchar *lastDownloadDir;
+    const gchar **lastHosts, **newHosts = NULL;
     gchar *peerSources = NULL;
-    gchar *lastDownloadDir = NULL;
-
-    downRate = torrent_get_rate_down(t);
-    stats->downRateTotal += downRate;
-
-    upRate = torrent_get_rate_up(t);
-    stats->upRateTotal += upRate;
-
-    uploaded = torrent_get_uploaded(t);
-    downloaded = torrent_get_downloaded(t);
-    haveValid = torrent_get_have_valid(t);
-
-    downloadDir = (gchar *) torrent_get_download_dir(t);
-    rm_trailing_slashes(downloadDir);
-
-    id = torrent_get_id(t);
-    status = torrent_get_status(t);
-    fileCount = json_array_get_length(torrent_get_files(t));
-    newFlags =
-        torrent_get_flags(t, rpcv, status, fileCount, downRate, upRate);
-    statusString = torrent_get_status_string(rpcv, status, newFlags);
-    statusIcon = torrent_get_status_icon(rpcv, newFlags);
-    pf = torrent_get_peersfrom(t);
-    trackerStats = torrent_get_tracker_stats(t);
-
-    gtk_tree_model_get(GTK_TREE_MODEL(model), iter, TORRENT_COLUMN_FLAGS,
-                       &lastFlags, TORRENT_COLUMN_JSON, &lastJson,
-                       TORRENT_COLUMN_DOWNLOADDIR, &lastDownloadDir, -1);
-
-    json_object_ref(t);
-
-    if (json_array_get_length(trackerStats) > 0) {
-        JsonObject *firstTracker =
-            json_array_get_object_element(trackerStats,
-                                          0);
-        firstTrackerHost = trg_gregex_get_first(priv->urlHostRegex,
-                                                tracker_stats_get_host
-                                                (firstTracker));
-    }
-
-    lpd = peerfrom_get_lpd(pf);
-    if (newFlags & TORRENT_FLAG_ACTIVE) {
-        if (lpd >= 0) {
-            peerSources =
-                g_strdup_printf("%" G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / %" G_GINT64_FORMAT " / %"
-                                G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / %" G_GINT64_FORMAT " / %"
-                                G_GINT64_FORMAT, peerfrom_get_trackers(pf),
-                                peerfrom_get_incoming(pf),
-                                peerfrom_get_ltep(pf),
-                                peerfrom_get_dht(pf), peerfrom_get_pex(pf),
-                                lpd, peerfrom_get_resume(pf));
-        } else {
-            peerSources =
-                g_strdup_printf("%" G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / %" G_GINT64_FORMAT " / %"
-                                G_GINT64_FORMAT " / %" G_GINT64_FORMAT
-                                " / N/A / %" G_GINT64_FORMAT,
-                                peerfrom_get_trackers(pf),
-                                peerfrom_get_incoming(pf),
-                                peerfrom_get_ltep(pf),
-                                peerfrom_get_dht(pf), peerfrom_get_pex(pf),
-                                peerfrom_get_resume(pf));
+
+    row.n = 0;
+
+    newFlags = r->flags;
+
+    lastFlags = trg_torrent_model_get_flags(model, iter);
+    lastJson = trg_torrent_model_get_json(model, iter);
+    lastDownloadDir = trg_torrent_model_peek_string(model, iter,
+                                                    TORRENT_COLUMN_DOWNLOADDIR);
+    lastHosts = COLUMN_DATA(priv, const gchar **,
+                            TORRENT_COLUMN_TRACKER_HOSTS)[ITER_SLOT(iter)];
+
+    if (!priv->foldedNames[ITER_SLOT(iter)]
+        || g_strcmp0(r->name, trg_torrent_model_peek_string(model, iter,
+                                                            TORRENT_COLUMN_NAME)))
+        trg_torrent_model_index_name(priv, ITER_SLOT(iter), r->name);
+
+    /* Only the detail torrent has an object, which is kept until there's
+     * a newer one for it. */
+    newJson = lastJson;
+    if (r->json && r->json != lastJson) {
+        newJson = json_object_ref(r->json);
+        trg_torrent_model_keep_detail(model, r->id, newJson, lastJson);
+    } else if (!r->json && r->id != priv->detailId) {
+        newJson = NULL;
+    }
+
+    /* Always polled. */
+    trg_torrent_row_set_string(&row, TORRENT_COLUMN_ICON, r->statusIcon);
+    trg_torrent_row_set_string(&row, TORRENT_COLUMN_NAME, r->name);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_ERROR, r->error);
+    trg_torrent_row_set_string(&row, TORRENT_COLUMN_ERROR_STRING,
+                               r->errorString);
+    trg_torrent_row_set_string(&row, TORRENT_COLUMN_HASH_STRING,
+                               r->hashString);
+    trg_torrent_row_set_double(&row, TORRENT_COLUMN_PERCENTDONE,
+                               (newFlags & TORRENT_FLAG_CHECKING) ?
+                               r->recheckProgress : r->percentDone);
+    trg_torrent_row_set_string(&row, TORRENT_COLUMN_STATUS,
+                               r->statusString);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_DOWNSPEED,
+                              r->rateDownload);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_UPSPEED, r->rateUpload);
+    g_value_set_int(trg_torrent_row_add(&row, TORRENT_COLUMN_FLAGS,
+                                        G_TYPE_INT), newFlags);
+    g_value_set_uint(trg_torrent_row_add(&row, TORRENT_COLUMN_FILECOUNT,
+                                         G_TYPE_UINT), r->fileCount);
+    trg_torrent_row_set_string(&row, TORRENT_COLUMN_DOWNLOADDIR,
+                               r->downloadDir);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_BANDWIDTH_PRIORITY,
+                              r->bandwidthPriority);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_PEERS_FROM_US,
+                              r->peersGettingFromUs);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_UPLOAD_LIMIT,
+                              r->uploadLimit);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_UPLOAD_LIMITED,
+                              r->uploadLimited);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_DOWNLOAD_LIMIT,
+                              r->downloadLimit);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_DOWNLOAD_LIMITED,
+                              r->downloadLimited);
+    trg_torrent_row_set_double(&row,
+                               TORRENT_COLUMN_METADATAPERCENTCOMPLETE,
+                               r->metadataPercentComplete);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_QUEUE_POSITION,
+                              r->queuePosition);
+    trg_torrent_row_set_int64(&row, TORRENT_COLUMN_ID, r->id);
+    g_value_set_pointer(trg_torrent_row_add(&row, TORRENT_COLUMN_JSON,
+                                            G_TYPE_POINTER), newJson);
+    g_value_set_uint(trg_torrent_row_add(&row, TORRENT_COLUMN_VERSION,
+                                         G_TYPE_UINT), r->version);
+
+    /* Only polled while something is showing them. */
+    if (torrent_record_has(r, TORRENT_FIELD_SIZEWHENDONE))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_SIZEWHENDONE,
+                                  r->sizeWhenDone);
+
+    if (torrent_record_has(r, TORRENT_FIELD_TOTAL_SIZE))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_TOTALSIZE,
+                                  r->totalSize);
+
+    if (torrent_record_has(r, TORRENT_FIELD_ETA))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_ETA, r->eta);
+
+    if (torrent_record_has(r, TORRENT_FIELD_DOWNLOADEDEVER))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_DOWNLOADED,
+                                  r->downloadedEver);
+
+    if (torrent_record_has(r, TORRENT_FIELD_HAVEUNCHECKED))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_HAVE_UNCHECKED,
+                                  r->haveUnchecked);
+
+    if (torrent_record_has(r, TORRENT_FIELD_UPLOADEDEVER))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_UPLOADED,
+                                  r->uploadedEver);
+
+    if (torrent_record_has(r, TORRENT_FIELD_HAVEVALID))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_HAVE_VALID,
+                                  r->haveValid);
+
+    if (torrent_record_has(r, TORRENT_FIELD_UPLOADEDEVER)
+        && torrent_record_has(r, TORRENT_FIELD_HAVEVALID))
+        trg_torrent_row_set_double(&row, TORRENT_COLUMN_RATIO,
+                                   r->uploadedEver > 0
+                                   && r->haveValid > 0 ?
+                                   (double) r->uploadedEver /
+                                   (double) r->haveValid : 0);
+
+    if (torrent_record_has(r, TORRENT_FIELD_ADDED_DATE))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_ADDED,
+                                  r->addedDate);
+
+    if (torrent_record_has(r, TORRENT_FIELD_DONE_DATE))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_DONE_DATE,
+                                  r->doneDate);
+
+    if (torrent_record_has(r, TORRENT_FIELD_ACTIVITY_DATE))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_LASTACTIVE,
+                                  r->activityDate);
+
+    if (torrent_record_has(r, TORRENT_FIELD_PEERS_CONNECTED))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_PEERS_CONNECTED,
+                                  r->peersConnected);
+
+    if (torrent_record_has(r, TORRENT_FIELD_PEERS_SENDING_TO_US))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_PEERS_TO_US,
+                                  r->peersSendingToUs);
+
+    if (torrent_record_has(r, TORRENT_FIELD_WEB_SEEDS_SENDING_TO_US))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_WEB_SEEDS_TO_US,
+                                  r->webseedsSendingToUs);
+
+    if (torrent_record_has(r, TORRENT_FIELD_SEED_RATIO_LIMIT))
+        trg_torrent_row_set_double(&row, TORRENT_COLUMN_SEED_RATIO_LIMIT,
+                                   r->seedRatioLimit);
+
+    if (torrent_record_has(r, TORRENT_FIELD_SEED_RATIO_MODE))
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_SEED_RATIO_MODE,
+                                  r->seedRatioMode);
+
+    if (torrent_record_has(r, TORRENT_FIELD_PEERSFROM)) {
+        if (newFlags & TORRENT_FLAG_ACTIVE)
+            peerSources = trg_torrent_model_peer_sources(r);
+
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_FROMPEX,
+                                  r->fromPex);
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_FROMDHT,
+                                  r->fromDht);
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_FROMTRACKERS,
+                                  r->fromTrackers);
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_FROMLTEP,
+                                  r->fromLtep);
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_FROMRESUME,
+                                  r->fromResume);
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_FROMINCOMING,
+                                  r->fromIncoming);
+        trg_torrent_row_set_string(&row, TORRENT_COLUMN_PEER_SOURCES,
+                                   peerSources);
+    }
+
+    if (torrent_record_has(r, TORRENT_FIELD_TRACKER_STATS)) {
+        trg_torrent_row_set_string(&row, TORRENT_COLUMN_TRACKERHOST,
+                                   r->trackerHost ? r->trackerHost : "");
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_SEEDS, r->seeders);
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_LEECHERS,
+                                  r->leechers);
+        trg_torrent_row_set_int64(&row, TORRENT_COLUMN_DOWNLOADS,
+                                  r->downloads);
+
+        if (!trg_torrent_model_hosts_equal(lastHosts, r->trackerHosts)) {
+            gsize size = (g_strv_length((gchar **) r->trackerHosts) + 1)
+                * sizeof(const gchar *);
+
+            newHosts = g_malloc(size);
+            memcpy(newHosts, r->trackerHosts, size);
+            g_value_set_pointer(trg_torrent_row_add
+                                (&row, TORRENT_COLUMN_TRACKER_HOSTS,
+                                 G_TYPE_POINTER), newHosts);
+            trg_torrent_model_facet_add_hosts(priv, lastHosts, -1);
+            trg_torrent_model_facet_add_hosts(priv, newHosts, 1);
+            *whatsChanged |= TORRENT_UPDATE_TRACKER_CHANGE;
         }
     }
-#ifdef TRG_DEBUG
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ICON, statusIcon, -1);
-    gtk_list_store_set(ls, iter,
-                       TORRENT_COLUMN_NAME, torrent_get_name(t), -1);
-    gtk_list_store_set(ls, iter,
-                       TORRENT_COLUMN_SIZEWHENDONE,
-                       torrent_get_size_when_done(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PERCENTDONE,
-                       (newFlags & TORRENT_FLAG_CHECKING) ?
-                       torrent_get_recheck_progress(t)
-                       : torrent_get_percent_done(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_STATUS, statusString, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNSPEED, downRate, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_FLAGS, newFlags, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_UPSPEED, upRate, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ETA, torrent_get_eta(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_UPLOADED, uploaded, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNLOADED, downloaded,
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_RATIO, uploaded > 0
-                       && downloaded >
-                       0 ? (double) uploaded / (double) downloaded : 0,
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ID, id, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_JSON, t, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_UPDATESERIAL, serial, -1);
-    gtk_list_store_set(ls, iter,
-                       TORRENT_COLUMN_ADDED, torrent_get_added_date(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNLOADDIR, downloadDir,
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PEERS_CONNECTED, torrent_get_peers_connected(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ETA, torrent_get_eta(t),
-                       -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_BANDWIDTH_PRIORITY,
-                       torrent_get_bandwidth_priority(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_TOTALSIZE,
-                       torrent_get_total_size(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_HAVE_UNCHECKED,
-                       torrent_get_have_unchecked(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_METADATAPERCENTCOMPLETE,
-                       torrent_get_metadata_percent_complete(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PEERS_TO_US,
-                       torrent_get_peers_sending_to_us(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_PEERS_FROM_US,
-                       torrent_get_peers_getting_from_us(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_WEB_SEEDS_TO_US,
-                       torrent_get_web_seeds_sending_to_us(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_SEED_RATIO_LIMIT,
-                       torrent_get_seed_ratio_limit(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_SEED_RATIO_MODE,
-                       torrent_get_seed_ratio_mode(t), -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_FILECOUNT, fileCount, -1);
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_HAVE_VALID, haveValid, -1);
-#else
-    gtk_list_store_set(ls, iter, TORRENT_COLUMN_ICON, statusIcon,
-                       TORRENT_COLUMN_ADDED, torrent_get_added_date(t),
-                       TORRENT_COLUMN_FILECOUNT,
-                       fileCount,
-                       TORRENT_COLUMN_DONE_DATE, torrent_get_done_date(t),
-                       TORRENT_COLUMN_NAME, torrent_get_name(t),
-                       TORRENT_COLUMN_ERROR, torrent_get_error(t),
-                       TORRENT_COLUMN_SIZEWHENDONE,
-                       torrent_get_size_when_done(t),
-                       TORRENT_COLUMN_PERCENTDONE,
-                       (newFlags & TORRENT_FLAG_CHECKING) ?
-                       torrent_get_recheck_progress(t)
-                       : torrent_get_percent_done(t),
-                       TORRENT_COLUMN_METADATAPERCENTCOMPLETE,
-                       torrent_get_metadata_percent_complete(t),
-                       TORRENT_COLUMN_STATUS, statusString,
-                       TORRENT_COLUMN_DOWNSPEED, downRate,
-                       TORRENT_COLUMN_FLAGS, newFlags,
-                       TORRENT_COLUMN_UPSPEED, upRate, TORRENT_COLUMN_ETA,
-                       torrent_get_eta(t), TORRENT_COLUMN_UPLOADED,
-                       uploaded, TORRENT_COLUMN_DOWNLOADED, downloaded,
-                       TORRENT_COLUMN_TOTALSIZE, torrent_get_total_size(t),
-                       TORRENT_COLUMN_HAVE_UNCHECKED,
-                       torrent_get_have_unchecked(t),
-                       TORRENT_COLUMN_HAVE_VALID, haveValid,
-                       TORRENT_COLUMN_FROMPEX, peerfrom_get_pex(pf),
-                       TORRENT_COLUMN_FROMDHT, peerfrom_get_dht(pf),
-                       TORRENT_COLUMN_FROMTRACKERS,
-                       peerfrom_get_trackers(pf), TORRENT_COLUMN_FROMLTEP,
-                       peerfrom_get_ltep(pf), TORRENT_COLUMN_FROMRESUME,
-                       peerfrom_get_resume(pf),
-                       TORRENT_COLUMN_FROMINCOMING,
-                       peerfrom_get_incoming(pf),
-                       TORRENT_COLUMN_PEER_SOURCES, peerSources,
-                       TORRENT_COLUMN_PEERS_CONNECTED,
-                       torrent_get_peers_connected(t),
-                       TORRENT_COLUMN_PEERS_TO_US,
-                       torrent_get_peers_sending_to_us(t),
-                       TORRENT_COLUMN_PEERS_FROM_US,
-                       torrent_get_peers_getting_from_us(t),
-                       TORRENT_COLUMN_WEB_SEEDS_TO_US,
-                       torrent_get_web_seeds_sending_to_us(t),
-                       TORRENT_COLUMN_QUEUE_POSITION,
-                       torrent_get_queue_position(t),
-                       TORRENT_COLUMN_SEED_RATIO_LIMIT,
-                       torrent_get_seed_ratio_limit(t),
-                       TORRENT_COLUMN_SEED_RATIO_MODE,
-                       torrent_get_seed_ratio_mode(t),
-                       TORRENT_COLUMN_LASTACTIVE,
-                       torrent_get_activity_date(t), TORRENT_COLUMN_RATIO,
-                       uploaded > 0
-                       && haveValid >
-                       0 ? (double) uploaded / (double) haveValid : 0,
-                       TORRENT_COLUMN_DOWNLOADDIR, downloadDir,
-                       TORRENT_COLUMN_BANDWIDTH_PRIORITY,
-                       torrent_get_bandwidth_priority(t),
-                       TORRENT_COLUMN_ID, id, TORRENT_COLUMN_JSON, t,
-                       TORRENT_COLUMN_TRACKERHOST,
-                       firstTrackerHost ? firstTrackerHost : "",
-                       TORRENT_COLUMN_UPDATESERIAL, serial, -1);
-#endif
 
-    if (!lastDownloadDir || g_strcmp0(downloadDir, lastDownloadDir)) {
-        gchar *shortDownloadDir = shorten_download_dir(tc, downloadDir);
-        gtk_list_store_set(ls, iter, TORRENT_COLUMN_DOWNLOADDIR_SHORT,
-                           shortDownloadDir, -1);
-        g_free(shortDownloadDir);
+    if (!lastDownloadDir || g_strcmp0(r->downloadDir, lastDownloadDir)) {
+        const gchar *shortDownloadDir =
+            trg_torrent_model_short_dir(model, tc, r->downloadDir);
+        trg_torrent_row_set_string(&row, TORRENT_COLUMN_DOWNLOADDIR_SHORT,
+                                   shortDownloadDir);
+        trg_torrent_model_facet_add(priv, TORRENT_FACET_DIR,
+                                    trg_torrent_model_peek_string(model,
+                                                                  iter,
+                                                                  TORRENT_COLUMN_DOWNLOADDIR_SHORT),
+                                    -1);
+        trg_torrent_model_facet_add(priv, TORRENT_FACET_DIR,
+                                    shortDownloadDir, 1);
         *whatsChanged |= TORRENT_UPDATE_PATH_CHANGE;
     }
 
-    if (lastJson)
+    trg_torrent_model_rates_account(priv, ITER_SLOT(iter), -1);
+    trg_torrent_row_commit(model, iter, &row, isNew);
+    trg_torrent_model_rates_account(priv, ITER_SLOT(iter), 1);
+
+    if (newHosts)
+        g_free(lastHosts);
+
+    if (lastJson && lastJson != newJson)
         json_object_unref(lastJson);
 
     if ((lastFlags & TORRENT_FLAG_DOWNLOADING)
@@ -639,20 +1863,16 @@ update_torrent_iter(TrgTorrentModel * model,
         && (newFlags & TORRENT_FLAG_COMPLETE))
         g_signal_emit(model, signals[TMODEL_TORRENT_COMPLETED], 0, iter);
 
+    if (isNew || lastFlags != newFlags) {
+        if (!isNew)
+            trg_torrent_model_stats_account(&priv->stats, lastFlags, -1);
+        trg_torrent_model_stats_account(&priv->stats, newFlags, 1);
+    }
+
     if (lastFlags != newFlags)
         *whatsChanged |= TORRENT_UPDATE_STATE_CHANGE;
 
-    trg_torrent_model_count_peers(model, iter, t);
-
-    if (firstTrackerHost)
-        g_free(firstTrackerHost);
-
-    if (peerSources)
-        g_free(peerSources);
-
-    g_free(lastDownloadDir);
-    g_free(statusString);
-    g_free(statusIcon);
+    g_free(peerSources);
 }
 
 TrgTorrentModel *trg_torrent_model_new(void)
@@ -660,194 +1880,153 @@ TrgTorrentModel *trg_torrent_model_new(void)
     return g_object_new(TRG_TYPE_TORRENT_MODEL, NULL);
 }
 
-struct TrgModelRemoveData {
-    GList *toRemove;
-    gint64 currentSerial;
-};
-
 GHashTable *get_torrent_table(TrgTorrentModel * model)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
     return priv->ht;
 }
 
-static gboolean
-trg_model_find_removed_foreachfunc(GtkTreeModel * model,
-                                   GtkTreePath *
-                                   path G_GNUC_UNUSED,
-                                   GtkTreeIter * iter, gpointer gdata)
+trg_torrents_shadow *trg_torrent_model_get_shadow(TrgTorrentModel * model)
 {
-    struct TrgModelRemoveData *args = (struct TrgModelRemoveData *) gdata;
-    gint64 rowSerial;
-
-    gtk_tree_model_get(model, iter, TORRENT_COLUMN_UPDATESERIAL,
-                       &rowSerial, -1);
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return priv->shadow;
+}
 
-    if (rowSerial != args->currentSerial) {
-        gint64 *id = g_new(gint64, 1);
-        gtk_tree_model_get(model, iter, TORRENT_COLUMN_ID, id, -1);
-        args->toRemove = g_list_append(args->toRemove, id);
-    }
+GHashTable *trg_torrent_model_get_facet(TrgTorrentModel * model,
+                                        gint facet)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return priv->facets[facet];
+}
 
-    return FALSE;
+GHashTable *trg_torrent_model_get_facet_changes(TrgTorrentModel * model,
+                                                gint facet)
+{
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    return priv->facetChanges[facet];
 }
 
-static GList *trg_torrent_model_find_removed(GtkTreeModel * model,
-                                      gint64 currentSerial)
+/* Whether the row already has everything in r, because the shadow found
+ * nothing changed since what the row was last given, or r is no newer
+ * than that (a request by id answered with the same response, say). An unchanged record still moves the row's version on, so a stale
+ * one that did change is rejected after it.
+ */
+
+static gboolean
+trg_torrent_model_row_is_current(TrgTorrentModel * model,
+                                 GtkTreeIter * iter,
+                                 const trg_torrent_record * r)
 {
-    struct TrgModelRemoveData args;
-    args.toRemove = NULL;
-    args.currentSerial = currentSerial;
+    TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
+    guint *version = &COLUMN_DATA(priv, guint,
+                                  TORRENT_COLUMN_VERSION)[ITER_SLOT(iter)];
+
+    if (!r->version)
+        return FALSE;
+
+    if (r->version <= *version)
+        return TRUE;
 
-    gtk_tree_model_foreach(GTK_TREE_MODEL(model),
-                           trg_model_find_removed_foreachfunc, &args);
+    if (r->changed)
+        return FALSE;
 
-    return args.toRemove;
+    *version = r->version;
+    return TRUE;
 }
 
 gboolean
 get_torrent_data(GHashTable * table, gint64 id, JsonObject ** t,
                  GtkTreeIter * out_iter)
 {
-    gpointer result = g_hash_table_lookup(table, &id);
-    gboolean found = FALSE;
-
-    if (result) {
-        GtkTreeRowReference *rr = (GtkTreeRowReference *) result;
-        GtkTreePath *path = gtk_tree_row_reference_get_path(rr);
-        GtkTreeIter iter;
-        if (path) {
-            GtkTreeModel *model = gtk_tree_row_reference_get_model(rr);
-            gtk_tree_model_get_iter(model, &iter, path);
-            if (out_iter)
-                *out_iter = iter;
-            if (t)
-                gtk_tree_model_get(model, &iter, TORRENT_COLUMN_JSON, t,
-                                   -1);
-            found = TRUE;
-            gtk_tree_path_free(path);
-        }
-    }
+    trg_torrent_table_entry *entry = g_hash_table_lookup(table, &id);
 
-    return found;
-}
+    if (!entry)
+        return FALSE;
 
-static void
-trg_torrent_model_stat_counts_clear(trg_torrent_model_update_stats * stats)
-{
-    stats->count = stats->down = stats->error = stats->paused =
-        stats->seeding = stats->complete = stats->incomplete =
-        stats->active = stats->checking = stats->seed_wait =
-        stats->down_wait = 0;
+    if (out_iter)
+        *out_iter = entry->iter;
+    if (t)
+        *t = trg_torrent_model_get_json(TRG_TORRENT_MODEL(entry->model),
+                                        &entry->iter);
+
+    return TRUE;
 }
 
 trg_torrent_model_update_stats *trg_torrent_model_update(TrgTorrentModel *
                                                          model,
                                                          TrgClient * tc,
-                                                         JsonObject *
-                                                         response,
+                                                         trg_torrent_records
+                                                         * records,
                                                          gint mode)
 {
     TrgTorrentModelPrivate *priv = TRG_TORRENT_MODEL_GET_PRIVATE(model);
 
-    GList *torrentList;
-    JsonObject *args, *t;
-    GList *li;
+    trg_torrent_record *r;
+    trg_torrent_table_entry *entry;
+    guint i;
     gint64 id;
-    gint64 serial = trg_client_get_serial(tc);
-    JsonArray *removedTorrents;
     GtkTreeIter iter;
-    GtkTreePath *path;
-    GtkTreeRowReference *rr;
-    gpointer *result;
     guint whatsChanged = 0;
 
-    gint64 rpcv = trg_client_get_rpc_version(tc);
+    /* From before a reconnect, or already in for another callback. */
+    if (records->applied
+        || !trg_torrents_shadow_commit(priv->shadow, records))
+        return &(priv->stats);
+
+    records->applied = TRUE;
 
-    args = get_arguments(response);
-    torrentList = json_array_get_elements(get_torrents(args));
+    trg_torrent_model_facet_changes_clear(priv);
 
-    priv->stats.downRateTotal = 0;
-    priv->stats.upRateTotal = 0;
+    /* Every row is new, so make room for them all at once. */
+    if (mode == TORRENT_GET_MODE_FIRST)
+        trg_torrent_model_reserve(priv,
+                                  priv->slots + records->torrents->len);
 
-    for (li = torrentList; li; li = g_list_next(li)) {
-        t = json_node_get_object((JsonNode *) li->data);
-        id = torrent_get_id(t);
+    for (i = 0; i < records->torrents->len; i++) {
+        r = &g_array_index(records->torrents, trg_torrent_record, i);
+        id = r->id;
 
-        result =
+        entry =
             mode == TORRENT_GET_MODE_FIRST ? NULL :
             g_hash_table_lookup(priv->ht, &id);
 
-        if (!result) {
-            gint64 *idCopy;
-            gtk_list_store_append(GTK_LIST_STORE(model), &iter);
+        if (!entry) {
+            trg_torrent_model_append(model, &iter);
             whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
 
-            update_torrent_iter(model, tc, rpcv, serial,
-                                &iter, t, &(priv->stats), &whatsChanged);
+            update_torrent_iter(model, tc, &iter, r, TRUE, &whatsChanged);
+            trg_torrent_model_row_inserted(model, &iter);
 
-            path = gtk_tree_model_get_path(GTK_TREE_MODEL(model), &iter);
-            rr = gtk_tree_row_reference_new(GTK_TREE_MODEL(model), path);
-            idCopy = g_new(gint64, 1);
-            *idCopy = id;
-            g_hash_table_insert(priv->ht, idCopy, rr);
-            gtk_tree_path_free(path);
+            entry = g_new(trg_torrent_table_entry, 1);
+            entry->id = id;
+            entry->model = GTK_TREE_MODEL(model);
+            entry->iter = iter;
+            g_hash_table_replace(priv->ht, &entry->id, entry);
 
             if (mode != TORRENT_GET_MODE_FIRST)
                 g_signal_emit(model, signals[TMODEL_TORRENT_ADDED], 0,
                               &iter);
-        } else {
-            path = gtk_tree_row_reference_get_path((GtkTreeRowReference *)
-                                                   result);
-            if (path) {
-                if (gtk_tree_model_get_iter(GTK_TREE_MODEL(model), &iter,
-                                            path)) {
-                    update_torrent_iter(model, tc, rpcv,
-                                        serial, &iter,
-                                        t, &(priv->stats), &whatsChanged);
-                }
-                gtk_tree_path_free(path);
-            }
+        } else if (!trg_torrent_model_row_is_current(model, &entry->iter,
+                                                     r)) {
+            iter = entry->iter;
+            update_torrent_iter(model, tc, &iter, r, FALSE, &whatsChanged);
         }
     }
 
-    g_list_free(torrentList);
+    /* From the daemon for an active-only update, or the shadow for a
+     * full one. */
+    if (mode > TORRENT_GET_MODE_FIRST && records->removed
+        && trg_torrent_model_remove_ids(model, records->removed) > 0)
+        whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
 
-    if (mode == TORRENT_GET_MODE_UPDATE) {
-        GList *hitlist =
-            trg_torrent_model_find_removed(GTK_TREE_MODEL(model), serial);
-        if (hitlist) {
-            for (li = hitlist; li; li = g_list_next(li)) {
-                g_hash_table_remove(priv->ht, li->data);
-                g_free(li->data);
-            }
-            whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
-            g_list_free(hitlist);
-        }
-    } else if (mode > TORRENT_GET_MODE_FIRST) {
-        removedTorrents = get_torrents_removed(args);
-        if (removedTorrents) {
-            GList *hitlist = json_array_get_elements(removedTorrents);
-            for (li = hitlist; li; li = g_list_next(li)) {
-                id = json_node_get_int((JsonNode *) li->data);
-                g_hash_table_remove(priv->ht, &id);
-                whatsChanged |= TORRENT_UPDATE_ADDREMOVE;
-            }
-            g_list_free(hitlist);
-        }
-    }
+#ifdef DEBUG
+    if (g_getenv("TRG_CHECK_STATS"))
+        trg_torrent_model_stats_check(priv);
+#endif
 
-    if (whatsChanged != 0) {
-        if ((whatsChanged & TORRENT_UPDATE_ADDREMOVE)
-            || (whatsChanged & TORRENT_UPDATE_STATE_CHANGE)) {
-            trg_torrent_model_stat_counts_clear(&priv->stats);
-            gtk_tree_model_foreach(GTK_TREE_MODEL(model),
-                                   trg_torrent_model_stats_scan_foreachfunc,
-                                   &(priv->stats));
-        }
+    if (whatsChanged != 0)
         g_signal_emit(model, signals[TMODEL_STATE_CHANGED], 0,
                       whatsChanged);
-    }
 
     g_signal_emit(model, signals[TMODEL_UPDATE], 0);
 
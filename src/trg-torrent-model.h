@@ -24,6 +24,7 @@
 #include <json-glib/json-glib.h>
 
 #include "trg-client.h"
+#include "torrent.h"
 
 G_BEGIN_DECLS
 #define TRG_TYPE_TORRENT_MODEL trg_torrent_model_get_type()
@@ -38,11 +39,11 @@ G_BEGIN_DECLS
 #define TRG_TORRENT_MODEL_GET_CLASS(obj) \
   (G_TYPE_INSTANCE_GET_CLASS ((obj), TRG_TYPE_TORRENT_MODEL, TrgTorrentModelClass))
     typedef struct {
-    GtkListStore parent;
+    GObject parent;
 } TrgTorrentModel;
 
 typedef struct {
-    GtkListStoreClass parent_class;
+    GObjectClass parent_class;
     void (*torrent_completed) (TrgTorrentModel * model,
                                GtkTreeIter * iter, gpointer data);
     void (*update) (TrgTorrentModel * model, gpointer data);
@@ -71,6 +72,7 @@ typedef struct {
 #define TORRENT_UPDATE_STATE_CHANGE        (1 << 0)
 #define TORRENT_UPDATE_PATH_CHANGE         (1 << 1)
 #define TORRENT_UPDATE_ADDREMOVE           (1 << 2)
+#define TORRENT_UPDATE_TRACKER_CHANGE      (1 << 3)
 
 GType trg_torrent_model_get_type(void);
 
@@ -84,13 +86,23 @@ find_existing_peer_item(GtkListStore * model, JsonObject * p,
 trg_torrent_model_update_stats *trg_torrent_model_update(TrgTorrentModel *
                                                          model,
                                                          TrgClient * tc,
-                                                         JsonObject *
-                                                         response,
+                                                         trg_torrent_records
+                                                         * records,
                                                          gint mode);
 trg_torrent_model_update_stats *trg_torrent_model_get_stats(TrgTorrentModel
                                                             * model);
 
+/* What the torrent table holds for each ID. The model's iters persist, so
+ * the iter is good until the row is removed, which also drops the entry.
+ */
+typedef struct {
+    gint64 id;
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+} trg_torrent_table_entry;
+
 GHashTable *get_torrent_table(TrgTorrentModel * model);
+trg_torrents_shadow *trg_torrent_model_get_shadow(TrgTorrentModel * model);
 void trg_torrent_model_remove_all(TrgTorrentModel * model);
 
 gboolean trg_torrent_model_is_remove_in_progress(TrgTorrentModel * model);
@@ -101,6 +113,34 @@ gboolean get_torrent_data(GHashTable * table, gint64 id, JsonObject ** t,
 gchar *shorten_download_dir(TrgClient * tc, const gchar * downloadDir);
 void trg_torrent_model_reload_dir_aliases(TrgClient * tc,
                                           GtkTreeModel * model);
+guint64 trg_torrent_model_column_fields(gint column);
+
+gint trg_torrent_model_get_flags(TrgTorrentModel * model,
+                                 GtkTreeIter * iter);
+gint64 trg_torrent_model_get_int64(TrgTorrentModel * model,
+                                   GtkTreeIter * iter, gint column);
+gdouble trg_torrent_model_get_double(TrgTorrentModel * model,
+                                     GtkTreeIter * iter, gint column);
+const gchar *trg_torrent_model_peek_string(TrgTorrentModel * model,
+                                           GtkTreeIter * iter,
+                                           gint column);
+JsonObject *trg_torrent_model_get_json(TrgTorrentModel * model,
+                                       GtkTreeIter * iter);
+gboolean trg_torrent_model_has_tracker_host(TrgTorrentModel * model,
+                                            GtkTreeIter * iter,
+                                            const gchar * host);
+const gchar **trg_torrent_model_peek_tracker_hosts(TrgTorrentModel *
+                                                   model,
+                                                   GtkTreeIter * iter);
+const gchar *trg_torrent_model_peek_folded_name(TrgTorrentModel * model,
+                                                GtkTreeIter * iter);
+gint trg_torrent_model_compare(TrgTorrentModel * model, gint column,
+                               GtkTreeIter * a, GtkTreeIter * b);
+gchar *trg_torrent_model_fold_name(const gchar * name);
+gboolean trg_torrent_model_set_name_filter(TrgTorrentModel * model,
+                                           const gchar * text);
+gboolean trg_torrent_model_name_matches(TrgTorrentModel * model,
+                                        GtkTreeIter * iter);
 
 enum {
     TORRENT_COLUMN_ICON,
@@ -128,7 +168,7 @@ enum {
     TORRENT_COLUMN_ADDED,
     TORRENT_COLUMN_ID,
     TORRENT_COLUMN_JSON,
-    TORRENT_COLUMN_UPDATESERIAL,
+    TORRENT_COLUMN_VERSION,
     TORRENT_COLUMN_FLAGS,
     TORRENT_COLUMN_DOWNLOADDIR,
     TORRENT_COLUMN_DOWNLOADDIR_SHORT,
@@ -148,7 +188,28 @@ enum {
     TORRENT_COLUMN_ERROR,
     TORRENT_COLUMN_SEED_RATIO_MODE,
     TORRENT_COLUMN_SEED_RATIO_LIMIT,
+    TORRENT_COLUMN_TRACKER_HOSTS,
+    TORRENT_COLUMN_ERROR_STRING,
+    TORRENT_COLUMN_HASH_STRING,
+    TORRENT_COLUMN_UPLOAD_LIMIT,
+    TORRENT_COLUMN_UPLOAD_LIMITED,
+    TORRENT_COLUMN_DOWNLOAD_LIMIT,
+    TORRENT_COLUMN_DOWNLOAD_LIMITED,
     TORRENT_COLUMN_COLUMNS
 };
 
+/* What torrents can be filtered by besides state. For each, a table from
+ * the interned name to how many torrents have it, and the set of names
+ * whose count changed in the last update. */
+enum {
+    TORRENT_FACET_TRACKER,
+    TORRENT_FACET_DIR,
+    TORRENT_FACET_COUNT
+};
+
+GHashTable *trg_torrent_model_get_facet(TrgTorrentModel * model,
+                                        gint facet);
+GHashTable *trg_torrent_model_get_facet_changes(TrgTorrentModel * model,
+                                                gint facet);
+
 #endif                          /* TRG_TORRENT_MODEL_H_ */
@@ -156,14 +156,23 @@ static GObject *trg_torrent_move_dialog_constructor(GType type,
     priv->ids = build_json_id_array(priv->treeview);
 
     if (count == 1) {
-        JsonObject *json;
-        const gchar *name;
+        GtkTreeSelection *selection =
+            gtk_tree_view_get_selection(GTK_TREE_VIEW(priv->treeview));
+        GtkTreeModel *model;
+        GList *rows = gtk_tree_selection_get_selected_rows(selection,
+                                                           &model);
+        GtkTreeIter iter;
+        gchar *name = NULL;
+
+        if (gtk_tree_model_get_iter(model, &iter,
+                                    (GtkTreePath *) rows->data))
+            gtk_tree_model_get(model, &iter, TORRENT_COLUMN_NAME, &name,
+                               -1);
 
-        get_torrent_data(trg_client_get_torrent_table(priv->client),
-                         trg_mw_get_selected_torrent_id(priv->win), &json,
-                         NULL);
-        name = torrent_get_name(json);
         msg = g_strdup_printf(_("Move %s"), name);
+
+        g_free(name);
+        g_list_free_full(rows, (GDestroyNotify) gtk_tree_path_free);
     } else {
         msg = g_strdup_printf(_("Move %d torrents"), count);
     }
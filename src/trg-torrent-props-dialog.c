@@ -483,7 +483,9 @@ static void models_updated(TrgTorrentModel * model, gpointer data)
                                                                   0), &t,
                                        &iter);
 
-    if (exists && priv->lastJson != t) {
+    /* Only the detail torrent has its JSON, which goes once another
+     * torrent's detail is received. */
+    if (exists && t && priv->lastJson != t) {
         trg_files_model_update(priv->filesModel,
                                GTK_TREE_VIEW(priv->filesTv), serial, t,
                                TORRENT_GET_MODE_UPDATE);
@@ -543,7 +545,10 @@ static GObject *trg_torrent_props_dialog_constructor(GType type,
         gtk_window_set_title(window, windowTitle);
         g_free(windowTitle);
     } else if (rowCount == 1) {
-        gtk_window_set_title(window, torrent_get_name(json));
+        gtk_window_set_title(window,
+                             trg_torrent_model_peek_string
+                             (priv->torrentModel, &iter,
+                              TORRENT_COLUMN_NAME));
     }
 
     gtk_window_set_transient_for(window, GTK_WINDOW(priv->parent));
@@ -0,0 +1,638 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "torrent.h"
+#include "util.h"
+#include "trg-torrent-model.h"
+#include "trg-torrent-query.h"
+
+/* The filter text is compiled once, when it changes, into a list of terms
+ * that the visible function runs through for each row. Terms are ordered
+ * cheapest first, so a row is usually turned down by a flag test or a
+ * number comparison before any string is looked at. Words that aren't
+ * terms go to the model's name filter, which keeps a match per row.
+ */
+
+/* In order of cost. */
+enum {
+    QUERY_TERM_FLAGS,
+    QUERY_TERM_NUMBER,
+    QUERY_TERM_AGE,
+    QUERY_TERM_DIR,
+    QUERY_TERM_TRACKER,
+    QUERY_TERM_NAME
+};
+
+enum {
+    QUERY_OP_LT,
+    QUERY_OP_LE,
+    QUERY_OP_GT,
+    QUERY_OP_GE,
+    QUERY_OP_EQ,
+    QUERY_OP_NE
+};
+
+enum {
+    QUERY_UNIT_NONE,
+    QUERY_UNIT_PERCENT,
+    QUERY_UNIT_SIZE,
+    QUERY_UNIT_SPEED,
+    QUERY_UNIT_DURATION
+};
+
+typedef struct {
+    gint kind;
+    gboolean negate;
+    gint column;
+    gboolean isDouble;
+    gint op;
+    gdouble value;
+    guint32 flags;
+    gchar **words;
+    guint index;
+} trg_query_term;
+
+struct _trg_torrent_query {
+    GArray *terms;
+    gchar *canonical;
+    gchar *nameText;
+    gboolean hasAge;
+    guint32 selectorFlags;
+    const gchar *selectorName;
+};
+
+static const struct {
+    const gchar *key;
+    gint column;
+    gboolean isDouble;
+    gint unit;
+    gint kind;
+} query_keys[] = {
+    {"ratio", TORRENT_COLUMN_RATIO, TRUE, QUERY_UNIT_NONE,
+     QUERY_TERM_NUMBER},
+    {"size", TORRENT_COLUMN_SIZEWHENDONE, FALSE, QUERY_UNIT_SIZE,
+     QUERY_TERM_NUMBER},
+    {"done", TORRENT_COLUMN_PERCENTDONE, TRUE, QUERY_UNIT_PERCENT,
+     QUERY_TERM_NUMBER},
+    {"progress", TORRENT_COLUMN_PERCENTDONE, TRUE, QUERY_UNIT_PERCENT,
+     QUERY_TERM_NUMBER},
+    {"down", TORRENT_COLUMN_DOWNSPEED, FALSE, QUERY_UNIT_SPEED,
+     QUERY_TERM_NUMBER},
+    {"up", TORRENT_COLUMN_UPSPEED, FALSE, QUERY_UNIT_SPEED,
+     QUERY_TERM_NUMBER},
+    {"uploaded", TORRENT_COLUMN_UPLOADED, FALSE, QUERY_UNIT_SIZE,
+     QUERY_TERM_NUMBER},
+    {"downloaded", TORRENT_COLUMN_DOWNLOADED, FALSE, QUERY_UNIT_SIZE,
+     QUERY_TERM_NUMBER},
+    {"eta", TORRENT_COLUMN_ETA, FALSE, QUERY_UNIT_DURATION,
+     QUERY_TERM_NUMBER},
+    {"peers", TORRENT_COLUMN_PEERS_CONNECTED, FALSE, QUERY_UNIT_NONE,
+     QUERY_TERM_NUMBER},
+    {"seeds", TORRENT_COLUMN_SEEDS, FALSE, QUERY_UNIT_NONE,
+     QUERY_TERM_NUMBER},
+    {"leechers", TORRENT_COLUMN_LEECHERS, FALSE, QUERY_UNIT_NONE,
+     QUERY_TERM_NUMBER},
+    {"queue", TORRENT_COLUMN_QUEUE_POSITION, FALSE, QUERY_UNIT_NONE,
+     QUERY_TERM_NUMBER},
+    {"added", TORRENT_COLUMN_ADDED, FALSE, QUERY_UNIT_DURATION,
+     QUERY_TERM_AGE},
+    {"completed", TORRENT_COLUMN_DONE_DATE, FALSE, QUERY_UNIT_DURATION,
+     QUERY_TERM_AGE},
+    {"active", TORRENT_COLUMN_LASTACTIVE, FALSE, QUERY_UNIT_DURATION,
+     QUERY_TERM_AGE},
+};
+
+static const struct {
+    const gchar *name;
+    guint32 flags;
+} query_states[] = {
+    {"downloading", TORRENT_FLAG_DOWNLOADING},
+    {"seeding", TORRENT_FLAG_SEEDING},
+    {"paused", TORRENT_FLAG_PAUSED},
+    {"complete", TORRENT_FLAG_COMPLETE},
+    {"incomplete", TORRENT_FLAG_INCOMPLETE},
+    {"checking", TORRENT_FLAG_CHECKING_ANY},
+    {"active", TORRENT_FLAG_ACTIVE},
+    {"error", TORRENT_FLAG_ERROR},
+    {"queued", TORRENT_FLAG_DOWNLOADING_WAIT | TORRENT_FLAG_SEEDING_WAIT},
+};
+
+static gboolean trg_query_parse_number(const gchar * text, gint unit,
+                                       gdouble * out)
+{
+    gchar *end;
+    gdouble value = g_ascii_strtod(text, &end);
+
+    if (end == text)
+        return FALSE;
+
+    switch (unit) {
+    case QUERY_UNIT_PERCENT:
+        if (*end == '%')
+            end++;
+        break;
+    case QUERY_UNIT_SIZE:
+    case QUERY_UNIT_SPEED:
+        {
+            gdouble k = unit == QUERY_UNIT_SIZE ? disk_K : speed_K;
+            const gchar *prefix =
+                *end ? strchr("kmgt", g_ascii_tolower(*end)) : NULL;
+
+            if (prefix) {
+                gint i;
+                for (i = 0; i <= prefix - "kmgt"; i++)
+                    value *= k;
+                end++;
+                if (g_ascii_tolower(*end) == 'i')
+                    end++;
+            }
+            if (g_ascii_tolower(*end) == 'b')
+                end++;
+            if (unit == QUERY_UNIT_SPEED && !g_ascii_strcasecmp(end, "/s"))
+                end += 2;
+        }
+        break;
+    case QUERY_UNIT_DURATION:
+        switch (g_ascii_tolower(*end)) {
+        case 'w':
+            value *= 7;
+            /* fall through */
+        case 'd':
+            value *= 24;
+            /* fall through */
+        case 'h':
+            value *= 60;
+            /* fall through */
+        case 'm':
+            value *= 60;
+            /* fall through */
+        case 's':
+            end++;
+        }
+        break;
+    }
+
+    if (*end != '\0')
+        return FALSE;
+
+    *out = value;
+    return TRUE;
+}
+
+/* A comparison like ratio>=2. */
+
+static gboolean trg_query_parse_comparison(const gchar * token,
+                                           trg_query_term * t)
+{
+    gsize keyLen = strcspn(token, "<>=!");
+    const gchar *op = token + keyLen;
+    gint opCode;
+    guint i;
+
+    if (keyLen == 0 || *op == '\0')
+        return FALSE;
+
+    for (i = 0; i < G_N_ELEMENTS(query_keys); i++) {
+        if (strlen(query_keys[i].key) == keyLen
+            && !g_ascii_strncasecmp(token, query_keys[i].key, keyLen))
+            break;
+    }
+
+    if (i == G_N_ELEMENTS(query_keys))
+        return FALSE;
+
+    if (g_str_has_prefix(op, "<=")) {
+        opCode = QUERY_OP_LE;
+        op += 2;
+    } else if (g_str_has_prefix(op, ">=")) {
+        opCode = QUERY_OP_GE;
+        op += 2;
+    } else if (g_str_has_prefix(op, "!=")) {
+        opCode = QUERY_OP_NE;
+        op += 2;
+    } else if (*op == '<') {
+        opCode = QUERY_OP_LT;
+        op++;
+    } else if (*op == '>') {
+        opCode = QUERY_OP_GT;
+        op++;
+    } else if (*op == '=') {
+        opCode = QUERY_OP_EQ;
+        op++;
+    } else {
+        return FALSE;
+    }
+
+    if (!trg_query_parse_number(op, query_keys[i].unit, &t->value))
+        return FALSE;
+
+    t->op = opCode;
+    t->kind = query_keys[i].kind;
+    t->column = query_keys[i].column;
+    t->isDouble = query_keys[i].isDouble;
+
+    return TRUE;
+}
+
+/* A key:value term, where value can be a comma separated list of
+ * alternatives. */
+
+static gboolean trg_query_parse_match(const gchar * token,
+                                      trg_query_term * t)
+{
+    const gchar *colon = strchr(token, ':');
+    gchar *key;
+    gchar **words;
+    gboolean known = TRUE;
+    guint i, j, n = 0;
+
+    if (!colon || colon == token || colon[1] == '\0')
+        return FALSE;
+
+    key = g_ascii_strdown(token, colon - token);
+    words = g_strsplit(colon + 1, ",", -1);
+
+    /* Drop empty alternatives, like those from a trailing comma. */
+    for (i = 0; words[i]; i++) {
+        if (*words[i])
+            words[n++] = words[i];
+        else
+            g_free(words[i]);
+    }
+    words[n] = NULL;
+
+    if (n == 0) {
+        known = FALSE;
+    } else if (!g_strcmp0(key, "state")) {
+        t->kind = QUERY_TERM_FLAGS;
+        for (i = 0; known && words[i]; i++) {
+            for (j = 0; j < G_N_ELEMENTS(query_states); j++) {
+                if (!g_ascii_strcasecmp(words[i], query_states[j].name)) {
+                    t->flags |= query_states[j].flags;
+                    break;
+                }
+            }
+            known = j < G_N_ELEMENTS(query_states);
+        }
+    } else if (!g_strcmp0(key, "name")) {
+        t->kind = QUERY_TERM_NAME;
+        for (i = 0; words[i]; i++) {
+            gchar *folded = trg_torrent_model_fold_name(words[i]);
+            g_free(words[i]);
+            words[i] = folded;
+        }
+    } else if (!g_strcmp0(key, "tracker")) {
+        t->kind = QUERY_TERM_TRACKER;
+    } else if (!g_strcmp0(key, "dir")) {
+        t->kind = QUERY_TERM_DIR;
+    } else {
+        known = FALSE;
+    }
+
+    g_free(key);
+
+    if (known && t->kind != QUERY_TERM_FLAGS)
+        t->words = words;
+    else
+        g_strfreev(words);
+
+    return known;
+}
+
+static gint trg_query_term_cmp(gconstpointer a, gconstpointer b)
+{
+    const trg_query_term *ta = a;
+    const trg_query_term *tb = b;
+
+    if (ta->kind != tb->kind)
+        return ta->kind - tb->kind;
+
+    return (gint) ta->index - (gint) tb->index;
+}
+
+/* Two queries with the same terms, in any order, get the same canonical
+ * string, so retyping a query doesn't refilter, unless it has an age
+ * term. */
+
+static gchar *trg_query_canonical(GArray * terms)
+{
+    GString *str = g_string_new(NULL);
+    GPtrArray *parts = g_ptr_array_new_with_free_func(g_free);
+    guint i;
+
+    for (i = 0; i < terms->len; i++) {
+        trg_query_term *t = &g_array_index(terms, trg_query_term, i);
+        gchar *words = t->words ? g_strjoinv(",", t->words) : NULL;
+
+        g_ptr_array_add(parts,
+                        g_strdup_printf("%d %d %d %d %.17g %u %s",
+                                        t->kind, t->negate, t->column,
+                                        t->op, t->value, t->flags,
+                                        words ? words : ""));
+        g_free(words);
+    }
+
+    g_ptr_array_sort(parts, (GCompareFunc) g_strcmp0);
+
+    for (i = 0; i < parts->len; i++) {
+        g_string_append(str, g_ptr_array_index(parts, i));
+        g_string_append_c(str, '\n');
+    }
+
+    g_ptr_array_free(parts, TRUE);
+    return g_string_free(str, FALSE);
+}
+
+trg_torrent_query *trg_torrent_query_compile(const gchar * text)
+{
+    trg_torrent_query *q = g_new0(trg_torrent_query, 1);
+    GRegex *opSpace =
+        g_regex_new("\\s*(<=|>=|!=|<|>|=)\\s*", G_REGEX_OPTIMIZE, 0,
+                    NULL);
+    gchar *squeezed =
+        g_regex_replace(opSpace, text ? text : "", -1, 0, "\\1", 0, NULL);
+    gchar **tokens = g_regex_split_simple("\\s+", squeezed, 0, 0);
+    GPtrArray *nameWords = g_ptr_array_new();
+    gchar **tok;
+
+    q->terms = g_array_new(FALSE, TRUE, sizeof(trg_query_term));
+
+    for (tok = tokens; *tok; tok++) {
+        const gchar *token = *tok;
+        trg_query_term t;
+
+        if (*token == '\0')
+            continue;
+
+        memset(&t, 0, sizeof(t));
+        t.index = q->terms->len;
+
+        if (token[0] == '-' && token[1] != '\0') {
+            t.negate = TRUE;
+            token++;
+        }
+
+        if (trg_query_parse_comparison(token, &t)
+            || trg_query_parse_match(token, &t)) {
+            q->hasAge |= t.kind == QUERY_TERM_AGE;
+            g_array_append_val(q->terms, t);
+        } else if (t.negate) {
+            /* A name word to leave out, which the name filter can't do. */
+            t.kind = QUERY_TERM_NAME;
+            t.words = g_new0(gchar *, 2);
+            t.words[0] = trg_torrent_model_fold_name(token);
+            g_array_append_val(q->terms, t);
+        } else {
+            g_ptr_array_add(nameWords, *tok);
+        }
+    }
+
+    g_array_sort(q->terms, trg_query_term_cmp);
+    q->canonical = trg_query_canonical(q->terms);
+
+    g_ptr_array_add(nameWords, NULL);
+    q->nameText = g_strjoinv(" ", (gchar **) nameWords->pdata);
+
+    g_ptr_array_free(nameWords, TRUE);
+    g_strfreev(tokens);
+    g_free(squeezed);
+    g_regex_unref(opSpace);
+
+    return q;
+}
+
+void trg_torrent_query_free(trg_torrent_query * q)
+{
+    guint i;
+
+    if (!q)
+        return;
+
+    for (i = 0; i < q->terms->len; i++)
+        g_strfreev(g_array_index(q->terms, trg_query_term, i).words);
+
+    g_array_free(q->terms, TRUE);
+    g_free(q->canonical);
+    g_free(q->nameText);
+    g_free(q);
+}
+
+/* The state selector's choice, evaluated before any term. name must be
+ * interned, as the selector keeps it. */
+
+void trg_torrent_query_set_selector(trg_torrent_query * q, guint32 flags,
+                                    const gchar * name)
+{
+    q->selectorFlags = flags;
+    q->selectorName = name;
+}
+
+/* A query with an age term is never the same as before, its matches move
+ * on with the clock. */
+
+gboolean trg_torrent_query_equal(const trg_torrent_query * a,
+                                 const trg_torrent_query * b)
+{
+    return a && b && !a->hasAge && !g_strcmp0(a->canonical, b->canonical);
+}
+
+/* Whether the query has an added<, completed< or active< term, so what it
+ * matches changes as time passes and not only when a row does. */
+
+gboolean trg_torrent_query_has_age(const trg_torrent_query * q)
+{
+    return q->hasAge;
+}
+
+const gchar *trg_torrent_query_get_name_text(const trg_torrent_query * q)
+{
+    return q->nameText;
+}
+
+/* The fields the list poll needs for the terms to be up to date. */
+
+guint64 trg_torrent_query_get_fields(const trg_torrent_query * q)
+{
+    guint64 fields = 0;
+    guint i;
+
+    for (i = 0; q && i < q->terms->len; i++) {
+        trg_query_term *t = &g_array_index(q->terms, trg_query_term, i);
+
+        if (t->kind == QUERY_TERM_NUMBER || t->kind == QUERY_TERM_AGE)
+            fields |= trg_torrent_model_column_fields(t->column);
+        else if (t->kind == QUERY_TERM_TRACKER)
+            fields |= TORRENT_FIELD_BIT(TORRENT_FIELD_TRACKER_STATS);
+    }
+
+    return fields;
+}
+
+static gboolean trg_query_contains(const gchar * haystack,
+                                   const gchar * needle)
+{
+    gsize len = strlen(needle);
+
+    if (!haystack)
+        return FALSE;
+
+    for (; *haystack; haystack++)
+        if (!g_ascii_strncasecmp(haystack, needle, len))
+            return TRUE;
+
+    return len == 0;
+}
+
+static gboolean trg_query_contains_any(const gchar * haystack,
+                                       gchar ** words)
+{
+    for (; *words; words++)
+        if (trg_query_contains(haystack, *words))
+            return TRUE;
+
+    return FALSE;
+}
+
+static gdouble trg_query_term_value(const trg_query_term * t,
+                                    TrgTorrentModel * model,
+                                    GtkTreeIter * iter, gint64 now)
+{
+    gint64 value;
+
+    if (t->isDouble)
+        return trg_torrent_model_get_double(model, iter, t->column);
+
+    value = trg_torrent_model_get_int64(model, iter, t->column);
+
+    /* Never active, not completed, or no ETA: as long ago as can be. */
+    if (t->kind == QUERY_TERM_AGE)
+        return value > 0 ? (gdouble) (now - value) : G_MAXDOUBLE;
+    else if (t->column == TORRENT_COLUMN_ETA && value < 0)
+        return G_MAXDOUBLE;
+
+    return (gdouble) value;
+}
+
+static gboolean trg_query_compare(gdouble value, gint op, gdouble operand)
+{
+    switch (op) {
+    case QUERY_OP_LT:
+        return value < operand;
+    case QUERY_OP_LE:
+        return value <= operand;
+    case QUERY_OP_GT:
+        return value > operand;
+    case QUERY_OP_GE:
+        return value >= operand;
+    case QUERY_OP_EQ:
+        return value == operand;
+    default:
+        return value != operand;
+    }
+}
+
+static gboolean trg_query_term_matches(const trg_query_term * t,
+                                       TrgTorrentModel * model,
+                                       GtkTreeIter * iter, gint64 now)
+{
+    gboolean result = FALSE;
+
+    switch (t->kind) {
+    case QUERY_TERM_FLAGS:
+        result = (trg_torrent_model_get_flags(model, iter) & t->flags) != 0;
+        break;
+    case QUERY_TERM_NUMBER:
+    case QUERY_TERM_AGE:
+        result = trg_query_compare(trg_query_term_value(t, model, iter,
+                                                        now), t->op,
+                                   t->value);
+        break;
+    case QUERY_TERM_DIR:
+        result =
+            trg_query_contains_any(trg_torrent_model_peek_string
+                                   (model, iter,
+                                    TORRENT_COLUMN_DOWNLOADDIR_SHORT),
+                                   t->words)
+            || trg_query_contains_any(trg_torrent_model_peek_string
+                                      (model, iter,
+                                       TORRENT_COLUMN_DOWNLOADDIR),
+                                      t->words);
+        break;
+    case QUERY_TERM_TRACKER:
+        {
+            const gchar **hosts =
+                trg_torrent_model_peek_tracker_hosts(model, iter);
+            for (; hosts && *hosts && !result; hosts++)
+                result = trg_query_contains_any(*hosts, t->words);
+        }
+        break;
+    case QUERY_TERM_NAME:
+        {
+            const gchar *folded =
+                trg_torrent_model_peek_folded_name(model, iter);
+            gchar **w;
+            for (w = t->words; folded && *w && !result; w++)
+                result = strstr(folded, *w) != NULL;
+        }
+        break;
+    }
+
+    return result != t->negate;
+}
+
+gboolean trg_torrent_query_matches(const trg_torrent_query * q,
+                                   TrgTorrentModel * model,
+                                   GtkTreeIter * iter)
+{
+    gint64 now;
+    guint i;
+
+    if (q->selectorFlags & FILTER_FLAG_TRACKER) {
+        if (!trg_torrent_model_has_tracker_host(model, iter,
+                                                q->selectorName))
+            return FALSE;
+    } else if (q->selectorFlags & FILTER_FLAG_DIR) {
+        if (trg_torrent_model_peek_string(model, iter,
+                                          TORRENT_COLUMN_DOWNLOADDIR_SHORT)
+            != q->selectorName)
+            return FALSE;
+    } else if (q->selectorFlags != 0
+               && !(trg_torrent_model_get_flags(model, iter) &
+                    q->selectorFlags)) {
+        return FALSE;
+    }
+
+    now = q->hasAge ? g_get_real_time() / G_USEC_PER_SEC : 0;
+
+    for (i = 0; i < q->terms->len; i++)
+        if (!trg_query_term_matches(&g_array_index(q->terms,
+                                                   trg_query_term, i),
+                                    model, iter, now))
+            return FALSE;
+
+    return TRUE;
+}
@@ -0,0 +1,52 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TRG_TORRENT_QUERY_H_
+#define TRG_TORRENT_QUERY_H_
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "trg-torrent-model.h"
+
+/* A filter for the torrent list, compiled from the text in the filter
+ * entry. Words separated by spaces must all match:
+ *   ratio>2 size>=50G done<100 added<7d active<1h down>100K
+ *   state:seeding,paused tracker:foo dir:bar name:baz
+ * A leading - negates a word, and after a key: commas separate
+ * alternatives. Anything else is searched for in the name, as one phrase.
+ */
+typedef struct _trg_torrent_query trg_torrent_query;
+
+trg_torrent_query *trg_torrent_query_compile(const gchar * text);
+void trg_torrent_query_free(trg_torrent_query * q);
+
+void trg_torrent_query_set_selector(trg_torrent_query * q, guint32 flags,
+                                    const gchar * name);
+gboolean trg_torrent_query_equal(const trg_torrent_query * a,
+                                 const trg_torrent_query * b);
+gboolean trg_torrent_query_has_age(const trg_torrent_query * q);
+const gchar *trg_torrent_query_get_name_text(const trg_torrent_query * q);
+guint64 trg_torrent_query_get_fields(const trg_torrent_query * q);
+
+gboolean trg_torrent_query_matches(const trg_torrent_query * q,
+                                   TrgTorrentModel * model,
+                                   GtkTreeIter * iter);
+
+#endif                          /* TRG_TORRENT_QUERY_H_ */
@@ -0,0 +1,1079 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <gtk/gtk.h>
+
+#include "trg-torrent-model.h"
+#include "trg-torrent-sort-model.h"
+
+/* Filters and sorts the torrent model for the torrent list, in place of a
+ * GtkTreeModelSort under a GtkTreeModelFilter. Those each kept an index of
+ * their own, and moved each changed row as its row-changed came in, so an
+ * update was done with sorting turned off and then everything was sorted
+ * again, every poll.
+ *
+ * Here there's one array, of the visible rows in order. A row's visibility
+ * is worked out when it's inserted or changed, or on a refilter.
+ *
+ * Here a changed row is only marked. When the update is over (or at high
+ * idle, for a change from somewhere else) the marked rows are taken out,
+ * sorted among themselves, and each is put back with a binary search of
+ * the rest, which are still in order. One rows-reordered goes out, or
+ * none if nothing moved. Ties go by ID, so the order is always the same
+ * for the same values.
+ *
+ * An iter holds the child's slot, so iters persist and converting one to
+ * the child's is a copy.
+ */
+
+static void
+trg_torrent_sort_model_tree_model_init(GtkTreeModelIface * iface);
+static void
+trg_torrent_sort_model_tree_sortable_init(GtkTreeSortableIface * iface);
+
+G_DEFINE_TYPE_WITH_CODE(TrgTorrentSortModel, trg_torrent_sort_model,
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+                                              trg_torrent_sort_model_tree_model_init)
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_SORTABLE,
+                                              trg_torrent_sort_model_tree_sortable_init))
+#define TRG_TORRENT_SORT_MODEL_GET_PRIVATE(o) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((o), TRG_TYPE_TORRENT_SORT_MODEL, TrgTorrentSortModelPrivate))
+typedef struct _TrgTorrentSortModelPrivate TrgTorrentSortModelPrivate;
+
+typedef struct {
+    GtkTreeIterCompareFunc func;
+    gpointer data;
+    GDestroyNotify destroy;
+} trg_sort_func;
+
+/* Order maps a position to the slot of a visible child row, positions
+ * goes the other way, brought up to date from dirtyFrom when asked for,
+ * as in the child. childOrder mirrors the child's order, so a row-deleted
+ * (which only has a path) can be turned into a slot.
+ */
+
+struct _TrgTorrentSortModelPrivate {
+    TrgTorrentModel *child;
+    gint childStamp;
+    gint stamp;
+
+    GArray *childOrder;
+    GArray *order;
+    guint *positions;
+    guint dirtyFrom;
+    guint capacity;
+
+    gboolean *visible;
+    GtkTreeModelFilterVisibleFunc visibleFunc;
+    gpointer visibleData;
+    GDestroyNotify visibleDestroy;
+
+    gboolean *dirty;
+    GArray *dirtySlots;
+    guint idleId;
+
+    gint sortColumn;
+    GtkSortType sortOrder;
+    GArray *sortFuncs;
+    trg_sort_func defaultFunc;
+
+#ifdef DEBUG
+    guint comparisons;
+#endif
+};
+
+#define ITER_SLOT(iter) (GPOINTER_TO_UINT((iter)->user_data) - 1)
+
+static void
+trg_torrent_sort_model_set_iter(TrgTorrentSortModelPrivate * priv,
+                                GtkTreeIter * iter, guint slot)
+{
+    iter->stamp = priv->stamp;
+    iter->user_data = GUINT_TO_POINTER(slot + 1);
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
+
+static void
+trg_torrent_sort_model_child_iter(TrgTorrentSortModelPrivate * priv,
+                                  GtkTreeIter * child_iter, guint slot)
+{
+    child_iter->stamp = priv->childStamp;
+    child_iter->user_data = GUINT_TO_POINTER(slot + 1);
+    child_iter->user_data2 = NULL;
+    child_iter->user_data3 = NULL;
+}
+
+static void
+trg_torrent_sort_model_grow(TrgTorrentSortModelPrivate * priv, guint slot)
+{
+    guint capacity = priv->capacity;
+
+    if (slot < capacity)
+        return;
+
+    while (slot >= capacity)
+        capacity = MAX(64, capacity * 2);
+
+    priv->positions = g_renew(guint, priv->positions, capacity);
+    priv->dirty = g_renew(gboolean, priv->dirty, capacity);
+    priv->visible = g_renew(gboolean, priv->visible, capacity);
+    memset(priv->dirty + priv->capacity, 0,
+           (capacity - priv->capacity) * sizeof(gboolean));
+    memset(priv->visible + priv->capacity, 0,
+           (capacity - priv->capacity) * sizeof(gboolean));
+    priv->capacity = capacity;
+}
+
+static void
+trg_torrent_sort_model_refresh_positions(TrgTorrentSortModelPrivate * priv)
+{
+    guint i;
+
+    for (i = priv->dirtyFrom; i < priv->order->len; i++)
+        priv->positions[g_array_index(priv->order, guint, i)] = i;
+
+    priv->dirtyFrom = G_MAXUINT;
+}
+
+static guint
+trg_torrent_sort_model_position(TrgTorrentSortModelPrivate * priv,
+                                guint slot)
+{
+    if (priv->positions[slot] >= priv->dirtyFrom)
+        trg_torrent_sort_model_refresh_positions(priv);
+
+    return priv->positions[slot];
+}
+
+/* Whether there's an order to keep, rather than the child's. */
+
+static gboolean
+trg_torrent_sort_model_is_sorted(TrgTorrentSortModelPrivate * priv)
+{
+    if (priv->sortColumn == GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+        return FALSE;
+    else if (priv->sortColumn == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+        return priv->defaultFunc.func != NULL;
+    else
+        return TRUE;
+}
+
+/* The visible rows in the child's order, for when there's no sort. */
+
+static void
+trg_torrent_sort_model_use_child_order(TrgTorrentSortModelPrivate * priv)
+{
+    guint i;
+
+    g_array_set_size(priv->order, 0);
+
+    for (i = 0; i < priv->childOrder->len; i++) {
+        guint slot = g_array_index(priv->childOrder, guint, i);
+        if (priv->visible[slot])
+            g_array_append_val(priv->order, slot);
+    }
+}
+
+static gboolean
+trg_torrent_sort_model_row_visible(TrgTorrentSortModelPrivate * priv,
+                                   guint slot)
+{
+    GtkTreeIter childIter;
+
+    if (!priv->visibleFunc)
+        return TRUE;
+
+    trg_torrent_sort_model_child_iter(priv, &childIter, slot);
+    return priv->visibleFunc(GTK_TREE_MODEL(priv->child), &childIter,
+                             priv->visibleData);
+}
+
+static gint
+trg_torrent_sort_model_compare(TrgTorrentSortModelPrivate * priv,
+                               guint slotA, guint slotB)
+{
+    GtkTreeModel *child = GTK_TREE_MODEL(priv->child);
+    trg_sort_func *sortFunc = NULL;
+    GtkTreeIter a, b;
+    gint result;
+    gint64 idA, idB;
+
+    trg_torrent_sort_model_child_iter(priv, &a, slotA);
+    trg_torrent_sort_model_child_iter(priv, &b, slotB);
+
+    if (priv->sortColumn == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+        sortFunc = &priv->defaultFunc;
+    else if ((guint) priv->sortColumn < priv->sortFuncs->len)
+        sortFunc = &g_array_index(priv->sortFuncs, trg_sort_func,
+                                  priv->sortColumn);
+
+#ifdef DEBUG
+    priv->comparisons++;
+#endif
+
+    if (sortFunc && sortFunc->func)
+        result = sortFunc->func(child, &a, &b, sortFunc->data);
+    else if (priv->sortColumn >= 0
+             && priv->sortColumn < TORRENT_COLUMN_COLUMNS)
+        result = trg_torrent_model_compare(priv->child, priv->sortColumn,
+                                           &a, &b);
+    else
+        result = 0;
+
+    if (result != 0)
+        return priv->sortOrder == GTK_SORT_DESCENDING ?
+            (result > 0 ? -1 : 1) : (result > 0 ? 1 : -1);
+
+    idA = trg_torrent_model_get_int64(priv->child, &a, TORRENT_COLUMN_ID);
+    idB = trg_torrent_model_get_int64(priv->child, &b, TORRENT_COLUMN_ID);
+
+    return idA < idB ? -1 : idA > idB;
+}
+
+static gint
+trg_torrent_sort_model_compare_slots(gconstpointer a, gconstpointer b,
+                                     gpointer data)
+{
+    return trg_torrent_sort_model_compare((TrgTorrentSortModelPrivate *)
+                                          data, *(const guint *) a,
+                                          *(const guint *) b);
+}
+
+/* Tell everyone about a new order. positions must still have the old
+ * one. */
+
+static void trg_torrent_sort_model_reordered(TrgTorrentSortModel * self)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    gint *newOrder = g_new(gint, MAX(priv->order->len, 1));
+    gboolean moved = FALSE;
+    guint i;
+
+    for (i = 0; i < priv->order->len; i++) {
+        newOrder[i] =
+            priv->positions[g_array_index(priv->order, guint, i)];
+        moved |= newOrder[i] != (gint) i;
+    }
+
+    priv->dirtyFrom = 0;
+
+    if (moved) {
+        GtkTreePath *path = gtk_tree_path_new();
+        gtk_tree_model_rows_reordered(GTK_TREE_MODEL(self), path, NULL,
+                                      newOrder);
+        gtk_tree_path_free(path);
+    }
+
+    g_free(newOrder);
+}
+
+static void trg_torrent_sort_model_clear_dirty(TrgTorrentSortModel * self)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    guint i;
+
+    for (i = 0; i < priv->dirtySlots->len; i++)
+        priv->dirty[g_array_index(priv->dirtySlots, guint, i)] = FALSE;
+
+    g_array_set_size(priv->dirtySlots, 0);
+
+    if (priv->idleId) {
+        g_source_remove(priv->idleId);
+        priv->idleId = 0;
+    }
+}
+
+/* Sort everything, for a new sort column or order. */
+
+static void trg_torrent_sort_model_sort(TrgTorrentSortModel * self)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+#ifdef DEBUG
+    gint64 started = g_get_monotonic_time();
+    priv->comparisons = 0;
+#endif
+
+    trg_torrent_sort_model_clear_dirty(self);
+    trg_torrent_sort_model_refresh_positions(priv);
+
+    if (trg_torrent_sort_model_is_sorted(priv))
+        g_array_sort_with_data(priv->order,
+                               trg_torrent_sort_model_compare_slots, priv);
+    else
+        trg_torrent_sort_model_use_child_order(priv);
+
+#ifdef DEBUG
+    if (g_getenv("TRG_SHOW_TIMING"))
+        g_message("sort of %u rows by column %d, %u comparisons in %"
+                  G_GINT64_FORMAT "us", priv->order->len,
+                  priv->sortColumn, priv->comparisons,
+                  g_get_monotonic_time() - started);
+#endif
+
+    trg_torrent_sort_model_reordered(self);
+}
+
+/* Put the rows that changed or were shown back in order. */
+
+static void trg_torrent_sort_model_flush(TrgTorrentSortModel * self)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    GArray *moved, *rest, *merged;
+    guint i, lo;
+
+    if (priv->dirtySlots->len == 0) {
+        trg_torrent_sort_model_clear_dirty(self);
+        return;
+    }
+
+    trg_torrent_sort_model_refresh_positions(priv);
+
+    if (!trg_torrent_sort_model_is_sorted(priv)) {
+        trg_torrent_sort_model_clear_dirty(self);
+        trg_torrent_sort_model_use_child_order(priv);
+        trg_torrent_sort_model_reordered(self);
+        return;
+    }
+
+    moved = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+                              priv->dirtySlots->len);
+    rest = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+                             priv->order->len);
+
+    for (i = 0; i < priv->order->len; i++) {
+        guint slot = g_array_index(priv->order, guint, i);
+        g_array_append_val(priv->dirty[slot] ? moved : rest, slot);
+    }
+
+    trg_torrent_sort_model_clear_dirty(self);
+
+    g_array_sort_with_data(moved, trg_torrent_sort_model_compare_slots,
+                           priv);
+
+    merged = g_array_sized_new(FALSE, FALSE, sizeof(guint),
+                               priv->order->len);
+
+    for (i = 0, lo = 0; i < moved->len; i++) {
+        guint slot = g_array_index(moved, guint, i);
+        guint start = lo;
+        guint hi = rest->len;
+
+        while (lo < hi) {
+            guint mid = lo + (hi - lo) / 2;
+
+            if (trg_torrent_sort_model_compare
+                (priv, slot, g_array_index(rest, guint, mid)) > 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        g_array_append_vals(merged, &g_array_index(rest, guint, start),
+                            lo - start);
+        g_array_append_val(merged, slot);
+    }
+
+    g_array_append_vals(merged, &g_array_index(rest, guint, lo),
+                        rest->len - lo);
+
+    g_array_free(priv->order, TRUE);
+    priv->order = merged;
+
+    g_array_free(moved, TRUE);
+    g_array_free(rest, TRUE);
+
+    trg_torrent_sort_model_reordered(self);
+}
+
+static gboolean trg_torrent_sort_model_flush_idle(gpointer data)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(data);
+
+    priv->idleId = 0;
+    trg_torrent_sort_model_flush(TRG_TORRENT_SORT_MODEL(data));
+
+    return FALSE;
+}
+
+/* Mark a row to be put back in order. That's done when the child's update
+ * is over, or before the next redraw for a change from elsewhere. */
+
+static void
+trg_torrent_sort_model_mark(TrgTorrentSortModel * self, guint slot)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+
+    if (priv->dirty[slot])
+        return;
+
+    priv->dirty[slot] = TRUE;
+    g_array_append_val(priv->dirtySlots, slot);
+
+    if (!priv->idleId)
+        priv->idleId = g_idle_add_full(G_PRIORITY_HIGH_IDLE,
+                                       trg_torrent_sort_model_flush_idle,
+                                       self, NULL);
+}
+
+/* A row becomes visible. It goes on the end for now and is marked, the
+ * next flush puts it in its place. */
+
+static void
+trg_torrent_sort_model_show(TrgTorrentSortModel * self, guint slot)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    GtkTreePath *path;
+    GtkTreeIter iter;
+
+    priv->visible[slot] = TRUE;
+    priv->positions[slot] = priv->order->len;
+    g_array_append_val(priv->order, slot);
+
+    trg_torrent_sort_model_set_iter(priv, &iter, slot);
+    path = gtk_tree_path_new_from_indices(priv->positions[slot], -1);
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(self), path, &iter);
+    gtk_tree_path_free(path);
+
+    trg_torrent_sort_model_mark(self, slot);
+}
+
+static void
+trg_torrent_sort_model_hide(TrgTorrentSortModel * self, guint slot)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    guint pos = trg_torrent_sort_model_position(priv, slot);
+    GtkTreePath *path;
+
+    g_array_remove_index(priv->order, pos);
+    priv->dirtyFrom = MIN(priv->dirtyFrom, pos);
+    priv->visible[slot] = FALSE;
+    priv->dirty[slot] = FALSE;
+
+    path = gtk_tree_path_new_from_indices(pos, -1);
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(self), path);
+    gtk_tree_path_free(path);
+}
+
+/* Child signals */
+
+static void
+trg_torrent_sort_model_child_row_inserted(GtkTreeModel *
+                                          child G_GNUC_UNUSED,
+                                          GtkTreePath * childPath,
+                                          GtkTreeIter * childIter,
+                                          gpointer data)
+{
+    TrgTorrentSortModel *self = TRG_TORRENT_SORT_MODEL(data);
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    guint slot = ITER_SLOT(childIter);
+
+    priv->childStamp = childIter->stamp;
+    trg_torrent_sort_model_grow(priv, slot);
+    priv->dirty[slot] = FALSE;
+    priv->visible[slot] = FALSE;
+
+    g_array_insert_val(priv->childOrder,
+                       gtk_tree_path_get_indices(childPath)[0], slot);
+
+    if (trg_torrent_sort_model_row_visible(priv, slot))
+        trg_torrent_sort_model_show(self, slot);
+}
+
+static void
+trg_torrent_sort_model_child_row_changed(GtkTreeModel *
+                                         child G_GNUC_UNUSED,
+                                         GtkTreePath *
+                                         childPath G_GNUC_UNUSED,
+                                         GtkTreeIter * childIter,
+                                         gpointer data)
+{
+    TrgTorrentSortModel *self = TRG_TORRENT_SORT_MODEL(data);
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    guint slot = ITER_SLOT(childIter);
+    gboolean visible = trg_torrent_sort_model_row_visible(priv, slot);
+    GtkTreePath *path;
+    GtkTreeIter iter;
+
+    if (!priv->visible[slot]) {
+        if (visible)
+            trg_torrent_sort_model_show(self, slot);
+        return;
+    } else if (!visible) {
+        trg_torrent_sort_model_hide(self, slot);
+        return;
+    }
+
+    trg_torrent_sort_model_set_iter(priv, &iter, slot);
+    path = gtk_tree_path_new_from_indices(trg_torrent_sort_model_position
+                                          (priv, slot), -1);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(self), path, &iter);
+    gtk_tree_path_free(path);
+
+    if (trg_torrent_sort_model_is_sorted(priv))
+        trg_torrent_sort_model_mark(self, slot);
+}
+
+static void
+trg_torrent_sort_model_child_row_deleted(GtkTreeModel *
+                                         child G_GNUC_UNUSED,
+                                         GtkTreePath * childPath,
+                                         gpointer data)
+{
+    TrgTorrentSortModel *self = TRG_TORRENT_SORT_MODEL(data);
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    guint childPos = gtk_tree_path_get_indices(childPath)[0];
+    guint slot = g_array_index(priv->childOrder, guint, childPos);
+
+    g_array_remove_index(priv->childOrder, childPos);
+
+    if (priv->visible[slot])
+        trg_torrent_sort_model_hide(self, slot);
+}
+
+static void
+trg_torrent_sort_model_child_update(TrgTorrentModel * child G_GNUC_UNUSED,
+                                    gpointer data)
+{
+    trg_torrent_sort_model_flush(TRG_TORRENT_SORT_MODEL(data));
+}
+
+/* GObject */
+
+static void trg_torrent_sort_model_dispose(GObject * object)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(object);
+
+    if (priv->idleId) {
+        g_source_remove(priv->idleId);
+        priv->idleId = 0;
+    }
+
+    if (priv->child) {
+        g_signal_handlers_disconnect_by_data(priv->child, object);
+        g_object_unref(priv->child);
+        priv->child = NULL;
+    }
+
+    if (priv->visibleDestroy)
+        priv->visibleDestroy(priv->visibleData);
+    priv->visibleFunc = NULL;
+    priv->visibleDestroy = NULL;
+
+    G_OBJECT_CLASS(trg_torrent_sort_model_parent_class)->dispose(object);
+}
+
+static void trg_sort_func_clear(trg_sort_func * sortFunc)
+{
+    if (sortFunc->destroy)
+        sortFunc->destroy(sortFunc->data);
+
+    sortFunc->func = NULL;
+    sortFunc->data = NULL;
+    sortFunc->destroy = NULL;
+}
+
+static void trg_torrent_sort_model_finalize(GObject * object)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(object);
+    guint i;
+
+    for (i = 0; i < priv->sortFuncs->len; i++)
+        trg_sort_func_clear(&g_array_index(priv->sortFuncs, trg_sort_func,
+                                           i));
+    trg_sort_func_clear(&priv->defaultFunc);
+
+    g_array_free(priv->sortFuncs, TRUE);
+    g_array_free(priv->childOrder, TRUE);
+    g_array_free(priv->order, TRUE);
+    g_array_free(priv->dirtySlots, TRUE);
+    g_free(priv->positions);
+    g_free(priv->dirty);
+    g_free(priv->visible);
+
+    G_OBJECT_CLASS(trg_torrent_sort_model_parent_class)->finalize(object);
+}
+
+static void
+trg_torrent_sort_model_class_init(TrgTorrentSortModelClass * klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    g_type_class_add_private(klass, sizeof(TrgTorrentSortModelPrivate));
+    object_class->dispose = trg_torrent_sort_model_dispose;
+    object_class->finalize = trg_torrent_sort_model_finalize;
+}
+
+static void trg_torrent_sort_model_init(TrgTorrentSortModel * self)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+
+    priv->stamp = g_random_int();
+    priv->childOrder = g_array_new(FALSE, FALSE, sizeof(guint));
+    priv->order = g_array_new(FALSE, FALSE, sizeof(guint));
+    priv->dirtySlots = g_array_new(FALSE, FALSE, sizeof(guint));
+    priv->sortFuncs = g_array_new(FALSE, TRUE, sizeof(trg_sort_func));
+    priv->dirtyFrom = G_MAXUINT;
+    priv->sortColumn = GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID;
+    priv->sortOrder = GTK_SORT_ASCENDING;
+}
+
+GtkTreeModel *trg_torrent_sort_model_new(TrgTorrentModel * child)
+{
+    TrgTorrentSortModel *self =
+        g_object_new(TRG_TYPE_TORRENT_SORT_MODEL, NULL);
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(self);
+    GtkTreeIter iter;
+
+    priv->child = g_object_ref(child);
+
+    if (gtk_tree_model_get_iter_first(GTK_TREE_MODEL(child), &iter)) {
+        do {
+            guint slot = ITER_SLOT(&iter);
+
+            priv->childStamp = iter.stamp;
+            trg_torrent_sort_model_grow(priv, slot);
+            priv->visible[slot] = TRUE;
+            priv->positions[slot] = priv->order->len;
+            g_array_append_val(priv->childOrder, slot);
+            g_array_append_val(priv->order, slot);
+        } while (gtk_tree_model_iter_next(GTK_TREE_MODEL(child), &iter));
+    }
+
+    g_signal_connect(child, "row-inserted",
+                     G_CALLBACK(trg_torrent_sort_model_child_row_inserted),
+                     self);
+    g_signal_connect(child, "row-changed",
+                     G_CALLBACK(trg_torrent_sort_model_child_row_changed),
+                     self);
+    g_signal_connect(child, "row-deleted",
+                     G_CALLBACK(trg_torrent_sort_model_child_row_deleted),
+                     self);
+    g_signal_connect(child, "update",
+                     G_CALLBACK(trg_torrent_sort_model_child_update),
+                     self);
+
+    return GTK_TREE_MODEL(self);
+}
+
+/* Which rows to show, as for a GtkTreeModelFilter, though the function is
+ * given the TrgTorrentModel and its iter. Call
+ * trg_torrent_sort_model_refilter() after. */
+
+void
+trg_torrent_sort_model_set_visible_func(TrgTorrentSortModel * model,
+                                        GtkTreeModelFilterVisibleFunc
+                                        func, gpointer data,
+                                        GDestroyNotify destroy)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(model);
+
+    if (priv->visibleDestroy)
+        priv->visibleDestroy(priv->visibleData);
+
+    priv->visibleFunc = func;
+    priv->visibleData = data;
+    priv->visibleDestroy = destroy;
+}
+
+/* Work out again which rows are visible. Those that went are deleted from
+ * the end back, so no removal moves one still to come, then those that
+ * came are put in place together. */
+
+void trg_torrent_sort_model_refilter(TrgTorrentSortModel * model)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(model);
+    guint i;
+#ifdef DEBUG
+    gint64 started = g_get_monotonic_time();
+#endif
+
+    for (i = priv->order->len; i > 0; i--) {
+        guint slot = g_array_index(priv->order, guint, i - 1);
+        GtkTreePath *path;
+
+        if (trg_torrent_sort_model_row_visible(priv, slot))
+            continue;
+
+        g_array_remove_index(priv->order, i - 1);
+        priv->dirtyFrom = MIN(priv->dirtyFrom, i - 1);
+        priv->visible[slot] = FALSE;
+        priv->dirty[slot] = FALSE;
+
+        path = gtk_tree_path_new_from_indices(i - 1, -1);
+        gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+        gtk_tree_path_free(path);
+    }
+
+    for (i = 0; i < priv->childOrder->len; i++) {
+        guint slot = g_array_index(priv->childOrder, guint, i);
+
+        if (!priv->visible[slot]
+            && trg_torrent_sort_model_row_visible(priv, slot))
+            trg_torrent_sort_model_show(model, slot);
+    }
+
+    trg_torrent_sort_model_flush(model);
+
+#ifdef DEBUG
+    if (g_getenv("TRG_SHOW_TIMING"))
+        g_message("refilter of %u rows, %u visible, in %" G_GINT64_FORMAT
+                  "us", priv->childOrder->len, priv->order->len,
+                  g_get_monotonic_time() - started);
+#endif
+}
+
+void
+trg_torrent_sort_model_convert_iter_to_child_iter(TrgTorrentSortModel *
+                                                  model,
+                                                  GtkTreeIter * child_iter,
+                                                  GtkTreeIter * iter)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(model);
+
+    g_return_if_fail(iter->stamp == priv->stamp);
+
+    trg_torrent_sort_model_child_iter(priv, child_iter, ITER_SLOT(iter));
+}
+
+/* GtkTreeModel */
+
+static GtkTreeModelFlags
+trg_torrent_sort_model_tree_get_flags(GtkTreeModel *
+                                      tree_model G_GNUC_UNUSED)
+{
+    return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint trg_torrent_sort_model_tree_get_n_columns(GtkTreeModel *
+                                                      tree_model)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+
+    return gtk_tree_model_get_n_columns(GTK_TREE_MODEL(priv->child));
+}
+
+static GType
+trg_torrent_sort_model_tree_get_column_type(GtkTreeModel * tree_model,
+                                            gint index)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+
+    return gtk_tree_model_get_column_type(GTK_TREE_MODEL(priv->child),
+                                          index);
+}
+
+static gboolean
+trg_torrent_sort_model_tree_get_iter(GtkTreeModel * tree_model,
+                                     GtkTreeIter * iter,
+                                     GtkTreePath * path)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+    gint i;
+
+    if (gtk_tree_path_get_depth(path) != 1)
+        return FALSE;
+
+    i = gtk_tree_path_get_indices(path)[0];
+    if (i < 0 || (guint) i >= priv->order->len)
+        return FALSE;
+
+    trg_torrent_sort_model_set_iter(priv, iter,
+                                    g_array_index(priv->order, guint, i));
+    return TRUE;
+}
+
+static GtkTreePath *trg_torrent_sort_model_tree_get_path(GtkTreeModel *
+                                                         tree_model,
+                                                         GtkTreeIter *
+                                                         iter)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+
+    g_return_val_if_fail(iter->stamp == priv->stamp, NULL);
+
+    return
+        gtk_tree_path_new_from_indices(trg_torrent_sort_model_position
+                                       (priv, ITER_SLOT(iter)), -1);
+}
+
+static void
+trg_torrent_sort_model_tree_get_value(GtkTreeModel * tree_model,
+                                      GtkTreeIter * iter, gint column,
+                                      GValue * value)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+    GtkTreeIter childIter;
+
+    g_return_if_fail(iter->stamp == priv->stamp);
+
+    trg_torrent_sort_model_child_iter(priv, &childIter, ITER_SLOT(iter));
+    gtk_tree_model_get_value(GTK_TREE_MODEL(priv->child), &childIter,
+                             column, value);
+}
+
+static gboolean trg_torrent_sort_model_tree_iter_next(GtkTreeModel *
+                                                      tree_model,
+                                                      GtkTreeIter * iter)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+    guint pos;
+
+    g_return_val_if_fail(iter->stamp == priv->stamp, FALSE);
+
+    pos = trg_torrent_sort_model_position(priv, ITER_SLOT(iter)) + 1;
+    if (pos >= priv->order->len) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_torrent_sort_model_set_iter(priv, iter,
+                                    g_array_index(priv->order, guint,
+                                                  pos));
+    return TRUE;
+}
+
+static gboolean trg_torrent_sort_model_tree_iter_previous(GtkTreeModel *
+                                                          tree_model,
+                                                          GtkTreeIter *
+                                                          iter)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+    guint pos;
+
+    g_return_val_if_fail(iter->stamp == priv->stamp, FALSE);
+
+    pos = trg_torrent_sort_model_position(priv, ITER_SLOT(iter));
+    if (pos == 0) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_torrent_sort_model_set_iter(priv, iter,
+                                    g_array_index(priv->order, guint,
+                                                  pos - 1));
+    return TRUE;
+}
+
+static gboolean
+trg_torrent_sort_model_tree_iter_nth_child(GtkTreeModel * tree_model,
+                                           GtkTreeIter * iter,
+                                           GtkTreeIter * parent, gint n)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+
+    if (parent || n < 0 || (guint) n >= priv->order->len) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    trg_torrent_sort_model_set_iter(priv, iter,
+                                    g_array_index(priv->order, guint, n));
+    return TRUE;
+}
+
+static gboolean
+trg_torrent_sort_model_tree_iter_children(GtkTreeModel * tree_model,
+                                          GtkTreeIter * iter,
+                                          GtkTreeIter * parent)
+{
+    return trg_torrent_sort_model_tree_iter_nth_child(tree_model, iter,
+                                                      parent, 0);
+}
+
+static gboolean
+trg_torrent_sort_model_tree_iter_has_child(GtkTreeModel *
+                                           tree_model G_GNUC_UNUSED,
+                                           GtkTreeIter *
+                                           iter G_GNUC_UNUSED)
+{
+    return FALSE;
+}
+
+static gint
+trg_torrent_sort_model_tree_iter_n_children(GtkTreeModel * tree_model,
+                                            GtkTreeIter * iter)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(tree_model);
+
+    return iter ? 0 : (gint) priv->order->len;
+}
+
+static gboolean
+trg_torrent_sort_model_tree_iter_parent(GtkTreeModel *
+                                        tree_model G_GNUC_UNUSED,
+                                        GtkTreeIter * iter,
+                                        GtkTreeIter * child G_GNUC_UNUSED)
+{
+    iter->stamp = 0;
+    return FALSE;
+}
+
+static void
+trg_torrent_sort_model_tree_model_init(GtkTreeModelIface * iface)
+{
+    iface->get_flags = trg_torrent_sort_model_tree_get_flags;
+    iface->get_n_columns = trg_torrent_sort_model_tree_get_n_columns;
+    iface->get_column_type = trg_torrent_sort_model_tree_get_column_type;
+    iface->get_iter = trg_torrent_sort_model_tree_get_iter;
+    iface->get_path = trg_torrent_sort_model_tree_get_path;
+    iface->get_value = trg_torrent_sort_model_tree_get_value;
+    iface->iter_next = trg_torrent_sort_model_tree_iter_next;
+    iface->iter_previous = trg_torrent_sort_model_tree_iter_previous;
+    iface->iter_children = trg_torrent_sort_model_tree_iter_children;
+    iface->iter_has_child = trg_torrent_sort_model_tree_iter_has_child;
+    iface->iter_n_children = trg_torrent_sort_model_tree_iter_n_children;
+    iface->iter_nth_child = trg_torrent_sort_model_tree_iter_nth_child;
+    iface->iter_parent = trg_torrent_sort_model_tree_iter_parent;
+}
+
+/* GtkTreeSortable */
+
+static gboolean
+trg_torrent_sort_model_get_sort_column_id(GtkTreeSortable * sortable,
+                                          gint * sort_column_id,
+                                          GtkSortType * order)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(sortable);
+
+    if (sort_column_id)
+        *sort_column_id = priv->sortColumn;
+    if (order)
+        *order = priv->sortOrder;
+
+    return priv->sortColumn != GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID
+        && priv->sortColumn != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+}
+
+static void
+trg_torrent_sort_model_set_sort_column_id(GtkTreeSortable * sortable,
+                                          gint sort_column_id,
+                                          GtkSortType order)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(sortable);
+
+    if (priv->sortColumn == sort_column_id && priv->sortOrder == order)
+        return;
+
+    priv->sortColumn = sort_column_id;
+    priv->sortOrder = order;
+
+    gtk_tree_sortable_sort_column_changed(sortable);
+    trg_torrent_sort_model_sort(TRG_TORRENT_SORT_MODEL(sortable));
+}
+
+static void
+trg_torrent_sort_model_set_sort_func(GtkTreeSortable * sortable,
+                                     gint sort_column_id,
+                                     GtkTreeIterCompareFunc func,
+                                     gpointer data, GDestroyNotify destroy)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(sortable);
+    trg_sort_func *sortFunc;
+
+    g_return_if_fail(sort_column_id >= 0);
+
+    if ((guint) sort_column_id >= priv->sortFuncs->len)
+        g_array_set_size(priv->sortFuncs, sort_column_id + 1);
+
+    sortFunc = &g_array_index(priv->sortFuncs, trg_sort_func,
+                              sort_column_id);
+    trg_sort_func_clear(sortFunc);
+    sortFunc->func = func;
+    sortFunc->data = data;
+    sortFunc->destroy = destroy;
+
+    if (priv->sortColumn == sort_column_id)
+        trg_torrent_sort_model_sort(TRG_TORRENT_SORT_MODEL(sortable));
+}
+
+static void
+trg_torrent_sort_model_set_default_sort_func(GtkTreeSortable * sortable,
+                                             GtkTreeIterCompareFunc func,
+                                             gpointer data,
+                                             GDestroyNotify destroy)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(sortable);
+
+    trg_sort_func_clear(&priv->defaultFunc);
+    priv->defaultFunc.func = func;
+    priv->defaultFunc.data = data;
+    priv->defaultFunc.destroy = destroy;
+
+    if (priv->sortColumn == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+        trg_torrent_sort_model_sort(TRG_TORRENT_SORT_MODEL(sortable));
+}
+
+static gboolean
+trg_torrent_sort_model_has_default_sort_func(GtkTreeSortable * sortable)
+{
+    TrgTorrentSortModelPrivate *priv =
+        TRG_TORRENT_SORT_MODEL_GET_PRIVATE(sortable);
+
+    return priv->defaultFunc.func != NULL;
+}
+
+static void
+trg_torrent_sort_model_tree_sortable_init(GtkTreeSortableIface * iface)
+{
+    iface->get_sort_column_id = trg_torrent_sort_model_get_sort_column_id;
+    iface->set_sort_column_id = trg_torrent_sort_model_set_sort_column_id;
+    iface->set_sort_func = trg_torrent_sort_model_set_sort_func;
+    iface->set_default_sort_func =
+        trg_torrent_sort_model_set_default_sort_func;
+    iface->has_default_sort_func =
+        trg_torrent_sort_model_has_default_sort_func;
+}
@@ -0,0 +1,64 @@
+/*
+ * transmission-remote-gtk - A GTK RPC client to Transmission
+ * Copyright (C) 2011-2013  Alan Fitton
+
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TRG_TORRENT_SORT_MODEL_H_
+#define TRG_TORRENT_SORT_MODEL_H_
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+
+#include "trg-torrent-model.h"
+
+G_BEGIN_DECLS
+#define TRG_TYPE_TORRENT_SORT_MODEL trg_torrent_sort_model_get_type()
+#define TRG_TORRENT_SORT_MODEL(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), TRG_TYPE_TORRENT_SORT_MODEL, TrgTorrentSortModel))
+#define TRG_TORRENT_SORT_MODEL_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), TRG_TYPE_TORRENT_SORT_MODEL, TrgTorrentSortModelClass))
+#define TRG_IS_TORRENT_SORT_MODEL(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TRG_TYPE_TORRENT_SORT_MODEL))
+#define TRG_IS_TORRENT_SORT_MODEL_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), TRG_TYPE_TORRENT_SORT_MODEL))
+#define TRG_TORRENT_SORT_MODEL_GET_CLASS(obj) \
+  (G_TYPE_INSTANCE_GET_CLASS ((obj), TRG_TYPE_TORRENT_SORT_MODEL, TrgTorrentSortModelClass))
+    typedef struct {
+    GObject parent;
+} TrgTorrentSortModel;
+
+typedef struct {
+    GObjectClass parent_class;
+} TrgTorrentSortModelClass;
+
+GType trg_torrent_sort_model_get_type(void);
+
+GtkTreeModel *trg_torrent_sort_model_new(TrgTorrentModel * child);
+
+G_END_DECLS
+    void
+trg_torrent_sort_model_convert_iter_to_child_iter(TrgTorrentSortModel *
+                                                  model,
+                                                  GtkTreeIter * child_iter,
+                                                  GtkTreeIter * iter);
+void trg_torrent_sort_model_set_visible_func(TrgTorrentSortModel * model,
+                                             GtkTreeModelFilterVisibleFunc
+                                             func, gpointer data,
+                                             GDestroyNotify destroy);
+void trg_torrent_sort_model_refilter(TrgTorrentSortModel * model);
+
+#endif                          /* TRG_TORRENT_SORT_MODEL_H_ */
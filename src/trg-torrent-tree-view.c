@@ -214,6 +214,21 @@ trg_torrent_tree_view_renderer_pref_changed(TrgPrefs * p,
     }
 }
 
+/* The model columns the transmission style renderer is given below. */
+static const gint transmission_layout_columns[] = {
+    TORRENT_COLUMN_FLAGS, TORRENT_COLUMN_ERROR, TORRENT_COLUMN_FILECOUNT,
+    TORRENT_COLUMN_TOTALSIZE, TORRENT_COLUMN_RATIO,
+    TORRENT_COLUMN_DOWNLOADED, TORRENT_COLUMN_HAVE_VALID,
+    TORRENT_COLUMN_SIZEWHENDONE, TORRENT_COLUMN_UPLOADED,
+    TORRENT_COLUMN_PERCENTDONE, TORRENT_COLUMN_METADATAPERCENTCOMPLETE,
+    TORRENT_COLUMN_UPSPEED, TORRENT_COLUMN_DOWNSPEED,
+    TORRENT_COLUMN_PEERS_TO_US, TORRENT_COLUMN_PEERS_FROM_US,
+    TORRENT_COLUMN_WEB_SEEDS_TO_US, TORRENT_COLUMN_ETA,
+    TORRENT_COLUMN_NAME, TORRENT_COLUMN_ERROR_STRING,
+    TORRENT_COLUMN_SEED_RATIO_MODE,
+    TORRENT_COLUMN_SEED_RATIO_LIMIT, TORRENT_COLUMN_PEERS_CONNECTED
+};
+
 static void setup_transmission_layout(TrgTorrentTreeView * tv,
                                       gint64 style)
 {
@@ -257,8 +272,10 @@ static void setup_transmission_layout(TrgTorrentTreeView * tv,
                                                  "webSeedsToUs",
                                                  TORRENT_COLUMN_WEB_SEEDS_TO_US,
                                                  "eta", TORRENT_COLUMN_ETA,
-                                                 "json",
-                                                 TORRENT_COLUMN_JSON,
+                                                 "name",
+                                                 TORRENT_COLUMN_NAME,
+                                                 "error-string",
+                                                 TORRENT_COLUMN_ERROR_STRING,
                                                  "seedRatioMode",
                                                  TORRENT_COLUMN_SEED_RATIO_MODE,
                                                  "seedRatioLimit",
@@ -307,6 +324,30 @@ trg_torrent_tree_view_pref_changed(TrgPrefs * p, const gchar * updatedKey,
     }
 }
 
+/* The torrent-get fields needed by whatever columns are on screen. */
+
+guint64 trg_torrent_tree_view_get_fields(TrgTorrentTreeView * tv)
+{
+    TrgTorrentTreeViewPrivate *priv = GET_PRIVATE(tv);
+    TrgPrefs *prefs = trg_client_get_prefs(priv->client);
+    guint64 fields = 0;
+    guint i;
+
+    if (trg_prefs_get_int(prefs, TRG_PREFS_KEY_STYLE, TRG_PREFS_GLOBAL) !=
+        TRG_STYLE_CLASSIC) {
+        for (i = 0; i < G_N_ELEMENTS(transmission_layout_columns); i++)
+            fields |=
+                trg_torrent_model_column_fields
+                (transmission_layout_columns[i]);
+    } else {
+        for (i = 0; i < TORRENT_COLUMN_COLUMNS; i++)
+            if (trg_tree_view_is_column_showing(TRG_TREE_VIEW(tv), i))
+                fields |= trg_torrent_model_column_fields(i);
+    }
+
+    return fields;
+}
+
 TrgTorrentTreeView *trg_torrent_tree_view_new(TrgClient * tc,
                                               GtkTreeModel * model)
 {
@@ -330,8 +371,7 @@ TrgTorrentTreeView *trg_torrent_tree_view_new(TrgClient * tc,
     g_signal_connect(prefs, "pref-changed",
                      G_CALLBACK(trg_torrent_tree_view_pref_changed), obj);
 
-    trg_tree_view_restore_sort(TRG_TREE_VIEW(obj),
-                               TRG_TREE_VIEW_SORTABLE_PARENT);
+    trg_tree_view_restore_sort(TRG_TREE_VIEW(obj));
 
     return TRG_TORRENT_TREE_VIEW(obj);
 }
@@ -264,11 +264,8 @@ GtkWidget *trg_tree_view_sort_menu(TrgTreeView * tv, const gchar * label)
 {
     TrgTreeViewPrivate *priv = TRG_TREE_VIEW_GET_PRIVATE(tv);
     GtkWidget *item = gtk_menu_item_new_with_mnemonic(label);
-    GtkTreeModel *treeViewModel =
-        gtk_tree_view_get_model(GTK_TREE_VIEW(tv));
     GtkTreeSortable *sortableModel =
-        GTK_TREE_SORTABLE(gtk_tree_model_filter_get_model
-                          (GTK_TREE_MODEL_FILTER(treeViewModel)));
+        GTK_TREE_SORTABLE(gtk_tree_view_get_model(GTK_TREE_VIEW(tv)));
     GtkWidget *menu = gtk_menu_new();
     GtkWidget *b;
     GList *li;
@@ -606,6 +603,10 @@ void trg_tree_view_remove_all_columns(TrgTreeView * tv)
     GList *cols = gtk_tree_view_get_columns(gtv);
     GList *li;
     for (li = cols; li; li = g_list_next(li)) {
+        trg_column_description *desc =
+            g_object_get_data(G_OBJECT(li->data), GDATA_KEY_COLUMN_DESC);
+        if (desc)
+            desc->flags &= ~TRG_COLUMN_SHOWING;
         gtk_tree_view_remove_column(gtv, GTK_TREE_VIEW_COLUMN(li->data));
     }
     g_list_free(cols);
@@ -621,13 +622,7 @@ void trg_tree_view_persist(TrgTreeView * tv, guint flags)
     GtkSortType sort_type;
 
     if (flags & TRG_TREE_VIEW_PERSIST_SORT) {
-        gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE
-                                             ((flags &
-                                               TRG_TREE_VIEW_SORTABLE_PARENT)
-                                              ?
-                                              gtk_tree_model_filter_get_model
-                                              (GTK_TREE_MODEL_FILTER
-                                               (model)) : model),
+        gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE(model),
                                              &sort_column_id, &sort_type);
 
         if (json_object_has_member(props, TRG_PREFS_KEY_TV_SORT_COL))
@@ -675,7 +670,7 @@ void trg_tree_view_persist(TrgTreeView * tv, guint flags)
     }
 }
 
-void trg_tree_view_restore_sort(TrgTreeView * tv, guint flags)
+void trg_tree_view_restore_sort(TrgTreeView * tv)
 {
     JsonObject *props = trg_prefs_get_tree_view_props(tv);
     GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(tv));
@@ -686,13 +681,8 @@ void trg_tree_view_restore_sort(TrgTreeView * tv, guint flags)
                                                      TRG_PREFS_KEY_TV_SORT_COL);
         gint64 sort_type = json_object_get_int_member(props,
                                                       TRG_PREFS_KEY_TV_SORT_TYPE);
-        gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE
-                                             ((flags &
-                                               TRG_TREE_VIEW_SORTABLE_PARENT)
-                                              ?
-                                              gtk_tree_model_filter_get_model
-                                              (GTK_TREE_MODEL_FILTER
-                                               (model)) : model), sort_col,
+        gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(model),
+                                             sort_col,
                                              (GtkSortType) sort_type);
 
     }
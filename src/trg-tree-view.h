@@ -86,7 +86,6 @@ typedef struct {
 
 #define TRG_TREE_VIEW_PERSIST_SORT	   (1 << 0)
 #define TRG_TREE_VIEW_PERSIST_LAYOUT   (1 << 1)
-#define TRG_TREE_VIEW_SORTABLE_PARENT  (1 << 2)
 
 trg_column_description *trg_tree_view_reg_column(TrgTreeView * tv,
                                                  gint type,
@@ -98,7 +97,7 @@ void trg_tree_view_setup_columns(TrgTreeView * tv);
 void trg_tree_view_set_prefs(TrgTreeView * tv, TrgPrefs * prefs);
 void trg_tree_view_persist(TrgTreeView * tv, guint flags);
 void trg_tree_view_remove_all_columns(TrgTreeView * tv);
-void trg_tree_view_restore_sort(TrgTreeView * tv, guint flags);
+void trg_tree_view_restore_sort(TrgTreeView * tv);
 GtkWidget *trg_tree_view_sort_menu(TrgTreeView * tv, const gchar * label);
 gboolean trg_tree_view_is_column_showing(TrgTreeView * tv, gint index);
 